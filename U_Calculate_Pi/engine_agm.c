@@ -0,0 +1,218 @@
+/*
+ * engine_agm.c
+ *
+ * Created: 17.10.2026 17:05:48
+ */ 
+
+#include <math.h>
+#include "pi_engine.h"
+#include "mp_math.h"
+
+// Decimal digits produced, including the leading 3. The engine keeps
+// seven numbers of AGM_LIMBS limbs in the shared engine workspace.
+#ifndef AGM_DIGITS
+#define AGM_DIGITS        850
+#endif
+#define AGM_LIMBS         MP_LIMBS_FOR_DIGITS(AGM_DIGITS)
+
+#if AGM_LIMBS * 7 * 2 > ENGINE_WORKSPACE_SIZE
+#error AGM_DIGITS too large for ENGINE_WORKSPACE_SIZE
+#endif
+
+// Error after k iterations is below pi^2 2^(k+4) e^(-pi 2^(k+1)) / M^2,
+// M = AGM(1, 1/sqrt(2)). In decimal digits: 2^(k+1) * pi * log10(e)
+// - (k+4) * log10(2) - log10(pi^2 / M^2).
+#define AGM_DIGITS_SLOPE  1.364376
+#define AGM_LOG10_2       0.301030
+#define AGM_DIGITS_OFFSET 1.138330
+#define AGM_SQUARED       0.717770
+// Roundings of the float estimate relative to it: three limb reads, the
+// sum, the square and the division, each 2^-24 with some slack
+#define AGM_FLOAT_ROUNDING (8 * ENGINE_ROUNDOFF)
+
+typedef enum {
+	Phase_Iterate,
+	Phase_Divide,
+	Phase_Convert,
+	Phase_Done
+} agmPhase_e;
+
+static mpLimb_t *const a = (mpLimb_t *) engineWorkspace;
+static mpLimb_t *const b = (mpLimb_t *) engineWorkspace + AGM_LIMBS;
+static mpLimb_t *const t = (mpLimb_t *) engineWorkspace + 2 * AGM_LIMBS;
+static mpLimb_t *const product = (mpLimb_t *) engineWorkspace + 3 * AGM_LIMBS;
+static mpLimb_t *const scratch = (mpLimb_t *) engineWorkspace + 4 * AGM_LIMBS;
+// (a - b) / 2, only alive before the square root reuses the scratch blocks
+static mpLimb_t *const difference = (mpLimb_t *) engineWorkspace + 6 * AGM_LIMBS;
+
+static agmPhase_e phase;
+static uint8_t iterations;
+static uint16_t correct;           // digits guaranteed by the error formula
+static uint16_t released;
+static float estimate;
+static char latest[ENGINE_LATEST_DIGITS];
+
+// Correct digits including the leading 3 after the given iterations
+static uint16_t agmCorrectDigits(uint8_t k) {
+	float digits = AGM_DIGITS_SLOPE * (2UL << k) - (k + 4) * AGM_LOG10_2 - AGM_DIGITS_OFFSET;
+	
+	if (digits < 0) {
+		return 0;
+	}
+	if (digits >= AGM_DIGITS) {
+		return AGM_DIGITS;
+	}
+	return (uint16_t) digits + 1;
+}
+
+// (a + b)^2 / (4t) from the leading limbs
+static float agmFloatEstimate(void) {
+	float sum = mpToFloat(a, AGM_LIMBS) + mpToFloat(b, AGM_LIMBS);
+	
+	return sum * sum / (4 * mpToFloat(t, AGM_LIMBS));
+}
+
+// Shows the correct leading digits of the float estimate while iterating
+// (as many as a float holds)
+static void agmShowLeadingDigits(void) {
+	uint32_t leading = estimate * 1000000.0;
+	uint8_t count = correct < 7 ? correct : 7;
+	uint8_t i;
+	char digits[7];
+	
+	for (i = 7; i-- > 0; leading /= 10) {
+		digits[i] = '0' + leading % 10;
+	}
+	engineClearDigits(latest);
+	for (i = 0; i < count; i++) {
+		engineShiftDigit(latest, digits[i]);
+	}
+}
+
+static void agmInit(void) {
+	// a = 1, b = 1/sqrt(2), t = 1/4
+	mpSetInt(a, AGM_LIMBS, 1);
+	mpSetInt(product, AGM_LIMBS, 2);
+	mpInvSqrt(b, product, AGM_LIMBS, scratch);
+	mpSetInt(t, AGM_LIMBS, 1);
+	mpDivSmall(t, AGM_LIMBS, 4);
+	
+	engineClearDigits(latest);
+	phase = Phase_Iterate;
+	iterations = 0;
+	correct = 0;
+	released = 0;
+	estimate = agmFloatEstimate();
+}
+
+// One Gauss-Legendre iteration:
+// a' = (a + b) / 2, b' = sqrt(a b), t' = t - 2^k (a - a')^2
+static void agmIterate(void) {
+	mpMul(product, a, b, AGM_LIMBS);
+	
+	mpCopy(difference, a, AGM_LIMBS);
+	mpSub(difference, b, AGM_LIMBS);
+	mpDivSmall(difference, AGM_LIMBS, 2);
+	mpSub(a, difference, AGM_LIMBS);
+	
+	mpMul(scratch, difference, difference, AGM_LIMBS);
+	mpMulSmall(scratch, AGM_LIMBS, 1U << iterations);
+	mpSub(t, scratch, AGM_LIMBS);
+	
+	mpSqrt(b, product, AGM_LIMBS, scratch);
+	iterations++;
+}
+
+// pi = (a + b)^2 / (4t), the result is left in a
+static void agmDivide(void) {
+	mpCopy(product, a, AGM_LIMBS);
+	mpAdd(product, b, AGM_LIMBS);
+	mpMul(b, product, product, AGM_LIMBS);
+	mpMulSmall(t, AGM_LIMBS, 4);
+	mpDiv(a, b, t, AGM_LIMBS, scratch);
+}
+
+// A step is one iteration, the final division or one decimal digit
+static uint16_t agmStepBatch(uint16_t steps) {
+	uint16_t done;
+	
+	for (done = 0; done < steps && phase != Phase_Done; done++) {
+		switch (phase) {
+			case Phase_Iterate:
+				agmIterate();
+				correct = agmCorrectDigits(iterations);
+				estimate = agmFloatEstimate();
+				agmShowLeadingDigits();
+				if (correct >= AGM_DIGITS) {
+					phase = Phase_Divide;
+				}
+				break;
+				
+			case Phase_Divide:
+				agmDivide();
+				engineClearDigits(latest);
+				phase = Phase_Convert;
+				break;
+				
+			default:
+				// Emit the integer limb and shift the next decimal digit into it
+				engineShiftDigit(latest, '0' + a[0]);
+				a[0] = 0;
+				mpMulSmall(a, AGM_LIMBS, 10);
+				released++;
+				if (released == AGM_DIGITS) {
+					phase = Phase_Done;
+				}
+				break;
+		}
+	}
+	
+	return done;
+}
+
+static float agmEstimate(void) {
+	return estimate;
+}
+
+static float agmErrorBound(void) {
+	if (iterations == 0) {
+		return 1.0;
+	}
+	return M_PI * M_PI * (16UL << iterations) * exp(-M_PI * (2UL << iterations)) / AGM_SQUARED
+		+ estimate * AGM_FLOAT_ROUNDING;
+}
+
+// Only the digits latest actually holds count: the leading ones of the
+// float estimate while iterating, none while dividing, then the released
+static uint16_t agmDigits(char *buffer) {
+	engineCopyDigits(buffer, latest);
+	
+	switch (phase) {
+		case Phase_Iterate:
+			return correct < 7 ? correct : 7;
+		case Phase_Divide:
+			return 0;
+		default:
+			return released;
+	}
+}
+
+static const char *agmPhaseName(void) {
+	static const char *const names[] = { "iterate", "division", "conversion", "done" };
+	
+	return names[phase];
+}
+
+ENGINE_CONST piEngine_t agmEngine = {
+	.name = "AGM",
+	.termsPerStep = 1,
+	.batchLimit = 1,
+	.convergence = Convergence_Measured,
+	.maxDigits = AGM_DIGITS,
+	.init = agmInit,
+	.stepBatch = agmStepBatch,
+	.estimate = agmEstimate,
+	.errorBound = agmErrorBound,
+	.digits = agmDigits,
+	.phaseName = agmPhaseName,
+};
@@ -0,0 +1,183 @@
+/*
+ * engine_bbp.c
+ *
+ * Created: 17.10.2026 13:41:52
+ */ 
+
+#include "pi_engine.h"
+
+// Highest hexadecimal position that can be extracted. All moduli 8k+j
+// have to stay below 2^16, so products of two residues fit into 32 bits.
+#define BBP_MAX_POSITION  8000
+#define BBP_POSITION_STEP 1000
+// Terms k > d of the tail that still reach into the 32-bit fraction
+#define BBP_TAIL_TERMS    8
+
+static uint16_t start;             // first position of this run
+static uint16_t position;          // position d being extracted
+static uint16_t k;                 // next term of the sums
+static uint32_t fraction;          // fractional part of 16^d * pi, mod 2^32
+static uint16_t produced;
+static char latest[ENGINE_LATEST_DIGITS];
+static uint32_t leading;           // hex digits of the estimate
+
+// 16^exponent mod modulus, with modulus < 2^16
+static uint16_t powMod16(uint16_t exponent, uint16_t modulus) {
+	uint32_t result = 1;
+	uint32_t base = 16 % modulus;
+	
+	if (modulus == 1) {
+		return 0;
+	}
+	
+	while (exponent > 0) {
+		if (exponent & 1) {
+			result = (result * base) % modulus;
+		}
+		base = (base * base) % modulus;
+		exponent >>= 1;
+	}
+	
+	return result;
+}
+
+// residue / modulus as a 32-bit binary fraction, residue < modulus < 2^16
+static uint32_t fraction32(uint16_t residue, uint16_t modulus) {
+	uint32_t numerator = (uint32_t) residue << 16;
+	uint32_t high = numerator / modulus;
+	uint32_t low = ((numerator - high * modulus) << 16) / modulus;
+	
+	return (high << 16) | low;
+}
+
+// One term k of the series sum 16^(d-k) / (8k+j) for j = 1, 4, 5, 6,
+// already weighted with 4, -2, -1, -1. Only the fractional part matters,
+// which the wrap around of the 32-bit accumulator keeps for free.
+static uint32_t bbpTerm(uint16_t d, uint16_t term) {
+	uint16_t m = 8 * term;
+	uint8_t shift;
+	
+	if (term <= d) {
+		return 4 * fraction32(powMod16(d - term, m + 1), m + 1)
+			- 2 * fraction32(powMod16(d - term, m + 4), m + 4)
+			- fraction32(powMod16(d - term, m + 5), m + 5)
+			- fraction32(powMod16(d - term, m + 6), m + 6);
+	}
+	
+	// 16^(d-k) / (8k+j) is 2^(32 - 4(k-d)) / (8k+j) in the fraction
+	shift = 32 - 4 * (term - d);
+	return 4 * ((1UL << shift) / (m + 1))
+		- 2 * ((1UL << shift) / (m + 4))
+		- (1UL << shift) / (m + 5)
+		- (1UL << shift) / (m + 6);
+}
+
+static void bbpInit(void) {
+	engineClearDigits(latest);
+	position = start;
+	k = 0;
+	fraction = 0;
+	produced = 0;
+	leading = 0;
+}
+
+// One step adds one term k, a digit is complete after d + BBP_TAIL_TERMS steps
+static uint16_t bbpStepBatch(uint16_t steps) {
+	uint16_t done;
+	uint8_t digit;
+	
+	for (done = 0; done < steps && position <= BBP_MAX_POSITION; done++) {
+		fraction += bbpTerm(position, k);
+		k++;
+		
+		if (k == position + BBP_TAIL_TERMS) {
+			digit = fraction >> 28;
+			engineShiftDigit(latest, digit < 10 ? '0' + digit : 'A' + digit - 10);
+			if (start == 0 && produced < 6) {
+				leading = (leading << 4) | digit;
+			}
+			produced++;
+			
+			position++;
+			k = 0;
+			fraction = 0;
+		}
+	}
+	
+	return done;
+}
+
+// Only a run from position 0 gives the leading hex digits 3.243F6A...
+static float bbpEstimate(void) {
+	if (start != 0 || produced == 0) {
+		return 3.0;
+	}
+	return 3.0 + (float) leading / (1UL << (4 * (produced < 6 ? produced : 6)));
+}
+
+// The hex digits after the leading ones, and 3 plus those rounded to a
+// float
+static float bbpErrorBound(void) {
+	if (start != 0 || produced == 0) {
+		return 1.0;
+	}
+	return 1.0 / (1UL << (4 * (produced < 6 ? produced : 6))) + engineHalfUlp(bbpEstimate());
+}
+
+static uint16_t bbpDigits(char *buffer) {
+	engineCopyDigits(buffer, latest);
+	
+	return produced;
+}
+
+static uint32_t bbpGetParameter(void) {
+	return start;
+}
+
+// Jump the start position forward, wrapping back to the first digit
+static void bbpStepParameter(void) {
+	start += BBP_POSITION_STEP;
+	if (start > BBP_MAX_POSITION) {
+		start = 0;
+	}
+}
+
+// Checkpoints (36 bytes)
+static void bbpSaveState(uint8_t *state) {
+	state = engineSaveValue(state, &start, sizeof(start));
+	state = engineSaveValue(state, &position, sizeof(position));
+	state = engineSaveValue(state, &k, sizeof(k));
+	state = engineSaveValue(state, &fraction, sizeof(fraction));
+	state = engineSaveValue(state, &produced, sizeof(produced));
+	state = engineSaveValue(state, latest, sizeof(latest));
+	engineSaveValue(state, &leading, sizeof(leading));
+}
+
+static void bbpLoadState(const uint8_t *state) {
+	state = engineLoadValue(state, &start, sizeof(start));
+	state = engineLoadValue(state, &position, sizeof(position));
+	state = engineLoadValue(state, &k, sizeof(k));
+	state = engineLoadValue(state, &fraction, sizeof(fraction));
+	state = engineLoadValue(state, &produced, sizeof(produced));
+	state = engineLoadValue(state, latest, sizeof(latest));
+	engineLoadValue(state, &leading, sizeof(leading));
+}
+
+ENGINE_CONST piEngine_t bbpEngine = {
+	.name = "BBP hex",
+	.termsPerStep = 1,
+	.batchLimit = 64,
+	.convergence = Convergence_None,
+	.maxDigits = 0,
+	.init = bbpInit,
+	.stepBatch = bbpStepBatch,
+	.estimate = bbpEstimate,
+	.errorBound = bbpErrorBound,
+	.digits = bbpDigits,
+	.hexDigits = 1,
+	.parameterName = "n",
+	.getParameter = bbpGetParameter,
+	.stepParameter = bbpStepParameter,
+	.saveState = bbpSaveState,
+	.loadState = bbpLoadState,
+};
@@ -0,0 +1,387 @@
+/*
+ * engine_leibniz.c
+ *
+ * Created: 17.10.2026 10:05:40
+ */ 
+
+#include <math.h>
+#include "pi_engine.h"
+#include "pi_accelerate.h"
+#include "ff_math.h"
+#include "recip_math.h"
+
+// Fixed point Leibniz: pi is accumulated in Q4.60, a term 4/d = 2^62 / d
+// is the reciprocal of the normalised denominator shifted into place
+#define Q60_SHIFT           60
+// The fixed point engine stops here, the denominator keeps a free top bit
+#define FIXED_MAX_DENOM     (1UL << 30)
+// (4i+3)(4i+5) fits into 32 bits for all i below this
+#define PAIR_EXACT_STEPS    16384UL
+// Worst case rounding error one float-float step adds to the estimate
+#define FF_STEP_ROUNDING    5e-14
+// Same for the plain float engine: two additions to a sum in [1/2, 1),
+// each off by at most half an ulp of it, times 4
+#define FLOAT_STEP_ROUNDING (4 * ENGINE_ROUNDOFF)
+// Relative error of one term of the compensated engines: up to two
+// conversions, a multiplication and the division
+#define TERM_ROUNDING       (4 * ENGINE_ROUNDOFF)
+// Sum of |terms| of the paired engine, 1 + (1 - pi/4) and some margin
+#define PAIRED_MAGNITUDE    1.25
+
+static float sum;
+static uint32_t i;
+static piAccelerator_t accelerator;
+static float compensation;
+static ffFloat_t ffSum;
+static uint32_t pairDenom;
+static uint32_t pairDelta;
+
+static uint64_t ullSum;
+static int64_t llBinade;
+static uint32_t ulBinadeEnd;
+static uint8_t ucShift;
+static uint32_t d;
+
+//----------------------------------------------
+// float engine, pi/4 = 1 - 1/3 + 1/5 - ...
+//
+static void leibnizInit(void) {
+	sum = 1.0;
+	i = 0;
+	accelReset(&accelerator);
+	accelFeed(&accelerator, sum);
+}
+
+static uint16_t leibnizStepBatch(uint16_t steps) {
+	uint16_t k;
+	uint16_t feedFrom = 0;
+	
+	// Only the partial sums of the last steps reach the accelerator,
+	// together they refill its whole table
+	if (steps > (ACCEL_DEPTH + 1) / 2) {
+		feedFrom = steps - (ACCEL_DEPTH + 1) / 2;
+	}
+	
+	for (k = 0; k < steps; k++) {
+		if (k >= feedFrom) {
+			sum = sum - fReciprocal(3 + (4 * i));
+			accelFeed(&accelerator, sum);
+			sum = sum + fReciprocal(5 + (4 * i));
+			accelFeed(&accelerator, sum);
+		} else {
+			sum = sum - fReciprocal(3 + (4 * i)) + fReciprocal(5 + (4 * i));
+		}
+		i++;
+	}
+	
+	return steps;
+}
+
+static float leibnizEstimate(void) {
+	return sum * 4;
+}
+
+static float leibnizAccelerated(void) {
+	return accelEstimate(&accelerator) * 4;
+}
+
+// Alternating series, the exact partial sum is off by less than the
+// first omitted term 4/(3+4i)
+static float leibnizTailBound(void) {
+	return 4.0 / (3 + (4 * i));
+}
+
+// Tail, the rounding of the additions of every step so far and of the
+// terms, which fReciprocal() rounds once each. Their sum is bounded like
+// 1 + 1/3 + ... + 1/(4i+1) < 1 + ln(4i+1) / 2.
+static float leibnizErrorBound(void) {
+	float terms = 4 * ENGINE_ROUNDOFF * (1 + log(4.0 * i + 1) / 2);
+	
+	return leibnizTailBound() + i * FLOAT_STEP_ROUNDING + terms + engineHalfUlp(leibnizEstimate());
+}
+
+//----------------------------------------------
+// compensated float engine, same series with Kahan summation
+//
+static void leibnizCompensatedInit(void) {
+	sum = 1.0;
+	compensation = 0.0;
+	i = 0;
+}
+
+static float leibnizCompensatedEstimate(void) {
+	return (sum + compensation) * 4;
+}
+
+// Tail plus the rounding of the terms, of the Kahan sum of terms with
+// |terms| adding up to magnitude and of the final sum + compensation
+static float leibnizKahanBound(uint32_t terms, float magnitude) {
+	float rounding = engineKahanRounding(terms, magnitude) + TERM_ROUNDING * magnitude;
+	
+	return leibnizTailBound() + 4 * rounding + engineHalfUlp(leibnizCompensatedEstimate());
+}
+
+// 1 + 1/3 + ... + 1/(4i+1) < 1 + ln(4i+1) / 2
+static float leibnizCompensatedErrorBound(void) {
+	return leibnizKahanBound(2 * i + 1, 1 + log(4.0 * i + 1) / 2);
+}
+
+static uint16_t leibnizCompensatedStepBatch(uint16_t steps) {
+	uint16_t k;
+	
+	// Finished once the whole remaining tail can no longer change the
+	// float result, further terms would only burn cycles
+	if (leibnizTailBound() < engineHalfUlp(leibnizCompensatedEstimate())) {
+		return 0;
+	}
+	
+	for (k = 0; k < steps; k++) {
+		engineCompensatedAdd(&sum, &compensation, -fReciprocal(3 + (4 * i)));
+		engineCompensatedAdd(&sum, &compensation, fReciprocal(5 + (4 * i)));
+		i++;
+	}
+	
+	return steps;
+}
+
+//----------------------------------------------
+// paired float engine, -1/(4i+3) + 1/(4i+5) = -2/((4i+3)(4i+5)) needs one
+// division and one conversion per pair instead of two each. The pairs
+// shrink like 1/i^2 and fall below the float resolution of the sum after
+// about 2000 steps, so they are added with Kahan summation.
+//
+static void leibnizPairedInit(void) {
+	sum = 1.0;
+	compensation = 0.0;
+	i = 0;
+	// Denominator of the first pair and its increase to the next one,
+	// (4i+7)(4i+9) - (4i+3)(4i+5) = 32i + 48
+	pairDenom = 15;
+	pairDelta = 48;
+}
+
+static uint16_t leibnizPairedStepBatch(uint16_t steps) {
+	uint16_t k;
+	
+	for (k = 0; k < steps; k++) {
+		if (i < PAIR_EXACT_STEPS) {
+			engineCompensatedAdd(&sum, &compensation, -2 * fReciprocal(pairDenom));
+			pairDenom += pairDelta;
+			pairDelta += 32;
+		} else {
+			// The product no longer fits, round it in float instead
+			engineCompensatedAdd(&sum, &compensation, -2.0 / ((float) (3 + (4 * i)) * (5 + (4 * i))));
+		}
+		i++;
+	}
+	
+	return steps;
+}
+
+static float leibnizPairedErrorBound(void) {
+	return leibnizKahanBound(i + 1, PAIRED_MAGNITUDE);
+}
+
+//----------------------------------------------
+// float-float engine, the same pairs with about 14 digits of headroom
+//
+static void leibnizFloatFloatInit(void) {
+	ffSum = ffFromFloat(1.0);
+	i = 0;
+}
+
+static uint16_t leibnizFloatFloatStepBatch(uint16_t steps) {
+	uint16_t k;
+	
+	for (k = 0; k < steps; k++) {
+		ffSum = ffSub(ffSum, ffReciprocal(ffFromUint32(3 + (4 * i))));
+		ffSum = ffAdd(ffSum, ffReciprocal(ffFromUint32(5 + (4 * i))));
+		i++;
+	}
+	
+	return steps;
+}
+
+static float leibnizFloatFloatEstimate(void) {
+	return ffSum.hi * 4;
+}
+
+// Series tail plus the rounding of every step so far, the error of the
+// float-float sum
+static float leibnizFloatFloatSumBound(void) {
+	return leibnizTailBound() + i * FF_STEP_ROUNDING;
+}
+
+// The estimate is the sum rounded to a float
+static float leibnizFloatFloatErrorBound(void) {
+	return leibnizFloatFloatSumBound() + engineHalfUlp(leibnizFloatFloatEstimate());
+}
+
+// The digits the float-float sum guarantees
+static uint16_t leibnizFloatFloatDigits(char *latest) {
+	return engineIntervalDigits(ffMulFloat(ffSum, 4.0), leibnizFloatFloatSumBound(), latest, FF_DIGITS);
+}
+
+//----------------------------------------------
+// fixed point engine
+//
+
+// All terms of one binade 2^k < d < 2^(k+1) share the shift of their
+// reciprocals, so they are summed unshifted and only moved into the Q4.60
+// sum once per binade and batch
+static void leibnizFixedFold(void) {
+	ullSum += (uint64_t) llBinade << (ucShift - 1);
+	llBinade = 0;
+}
+
+// 2^(63 - s) / d for the shift s that normalises d, within the error of
+// the reciprocal kernel. Shifted by s - 1 that is 2^62 / d.
+static inline uint32_t ulFixedTerm(uint32_t ulDenom) {
+	if (ulDenom >= ulBinadeEnd) {
+		leibnizFixedFold();
+		ucShift--;
+		ulBinadeEnd <<= 1;
+	}
+	
+	return ulReciprocalEstimate(ulDenom << ucShift);
+}
+
+static void leibnizFixedInit(void) {
+	// Start with the first term 4/1 already added
+	ullSum = 4ULL << Q60_SHIFT;
+	llBinade = 0;
+	// 3 << 30 is the first normalised denominator
+	ucShift = 30;
+	ulBinadeEnd = 4;
+	d = 3;
+}
+
+static uint16_t leibnizFixedStepBatch(uint16_t steps) {
+	uint16_t k;
+	
+	if (d > FIXED_MAX_DENOM) {
+		return 0;
+	}
+	
+	// Same pairing as the float engine: - 4/d + 4/(d+2)
+	for (k = 0; k < steps; k++) {
+		llBinade -= ulFixedTerm(d);
+		llBinade += ulFixedTerm(d + 2);
+		d += 4;
+	}
+	leibnizFixedFold();
+	
+	return steps;
+}
+
+static float leibnizFixedEstimate(void) {
+	return ldexp((float) ullSum, -Q60_SHIFT);
+}
+
+// Tail, the kernel error of up to RECIP_ESTIMATE_ERROR + 1 in 2^31 of
+// each term on 4 (1 + 1/3 + ... + 1/d) < 3 + 2 ln d, and the conversion
+// to float
+static float leibnizFixedErrorBound(void) {
+	float rounding = ldexp((RECIP_ESTIMATE_ERROR + 1) * (3 + 2 * log(d)), -31);
+	
+	return 4.0 / d + rounding + engineHalfUlp(leibnizFixedEstimate());
+}
+
+//----------------------------------------------
+// checkpoints, one state for all engines of this file (45 bytes). The
+// accelerator is left out, it refills within the next batch.
+//
+static void leibnizSaveState(uint8_t *state) {
+	state = engineSaveValue(state, &sum, sizeof(sum));
+	state = engineSaveValue(state, &i, sizeof(i));
+	state = engineSaveValue(state, &compensation, sizeof(compensation));
+	state = engineSaveValue(state, &ffSum, sizeof(ffSum));
+	state = engineSaveValue(state, &pairDenom, sizeof(pairDenom));
+	state = engineSaveValue(state, &pairDelta, sizeof(pairDelta));
+	state = engineSaveValue(state, &ullSum, sizeof(ullSum));
+	state = engineSaveValue(state, &ulBinadeEnd, sizeof(ulBinadeEnd));
+	state = engineSaveValue(state, &ucShift, sizeof(ucShift));
+	engineSaveValue(state, &d, sizeof(d));
+}
+
+static void leibnizLoadState(const uint8_t *state) {
+	state = engineLoadValue(state, &sum, sizeof(sum));
+	state = engineLoadValue(state, &i, sizeof(i));
+	state = engineLoadValue(state, &compensation, sizeof(compensation));
+	state = engineLoadValue(state, &ffSum, sizeof(ffSum));
+	state = engineLoadValue(state, &pairDenom, sizeof(pairDenom));
+	state = engineLoadValue(state, &pairDelta, sizeof(pairDelta));
+	state = engineLoadValue(state, &ullSum, sizeof(ullSum));
+	state = engineLoadValue(state, &ulBinadeEnd, sizeof(ulBinadeEnd));
+	state = engineLoadValue(state, &ucShift, sizeof(ucShift));
+	engineLoadValue(state, &d, sizeof(d));
+	// Batches always end folded
+	llBinade = 0;
+}
+
+ENGINE_CONST piEngine_t leibnizEngine = {
+	.name = "Leibniz",
+	.termsPerStep = 2,
+	.convergence = Convergence_Algebraic,
+	.maxDigits = 3,
+	.init = leibnizInit,
+	.stepBatch = leibnizStepBatch,
+	.estimate = leibnizEstimate,
+	.errorBound = leibnizErrorBound,
+	.accelerated = leibnizAccelerated,
+	.saveState = leibnizSaveState,
+	.loadState = leibnizLoadState,
+};
+
+ENGINE_CONST piEngine_t leibnizPairedEngine = {
+	.name = "Leib Paired",
+	.termsPerStep = 2,
+	.convergence = Convergence_Algebraic,
+	.maxDigits = 6,
+	.init = leibnizPairedInit,
+	.stepBatch = leibnizPairedStepBatch,
+	.estimate = leibnizCompensatedEstimate,
+	.errorBound = leibnizPairedErrorBound,
+	.saveState = leibnizSaveState,
+	.loadState = leibnizLoadState,
+};
+
+ENGINE_CONST piEngine_t leibnizCompensatedEngine = {
+	.name = "Leibniz Cmp",
+	.termsPerStep = 2,
+	.convergence = Convergence_Algebraic,
+	.maxDigits = 4,
+	.init = leibnizCompensatedInit,
+	.stepBatch = leibnizCompensatedStepBatch,
+	.estimate = leibnizCompensatedEstimate,
+	.errorBound = leibnizCompensatedErrorBound,
+	.saveState = leibnizSaveState,
+	.loadState = leibnizLoadState,
+};
+
+ENGINE_CONST piEngine_t leibnizFloatFloatEngine = {
+	.name = "Leibniz FF",
+	.termsPerStep = 2,
+	.convergence = Convergence_Algebraic,
+	.maxDigits = 6,
+	.init = leibnizFloatFloatInit,
+	.stepBatch = leibnizFloatFloatStepBatch,
+	.estimate = leibnizFloatFloatEstimate,
+	.errorBound = leibnizFloatFloatErrorBound,
+	.digits = leibnizFloatFloatDigits,
+	.saveState = leibnizSaveState,
+	.loadState = leibnizLoadState,
+};
+
+ENGINE_CONST piEngine_t leibnizFixedEngine = {
+	.name = "Leibniz FP",
+	.termsPerStep = 2,
+	.convergence = Convergence_Algebraic,
+	.maxDigits = 7,
+	.init = leibnizFixedInit,
+	.stepBatch = leibnizFixedStepBatch,
+	.estimate = leibnizFixedEstimate,
+	.errorBound = leibnizFixedErrorBound,
+	.saveState = leibnizSaveState,
+	.loadState = leibnizLoadState,
+};
@@ -0,0 +1,148 @@
+/*
+ * engine_machin.c
+ *
+ * Created: 17.10.2026 15:40:13
+ */ 
+
+#include <math.h>
+#include "pi_engine.h"
+#include "mp_math.h"
+
+// Decimal digits produced, including the leading 3. Four numbers of
+// MACHIN_LIMBS limbs each are kept in the shared engine workspace.
+#ifndef MACHIN_DIGITS
+#define MACHIN_DIGITS     1000
+#endif
+#define MACHIN_LIMBS      MP_LIMBS_FOR_DIGITS(MACHIN_DIGITS)
+
+#if MACHIN_LIMBS * 4 * 2 > ENGINE_WORKSPACE_SIZE
+#error MACHIN_DIGITS too large for ENGINE_WORKSPACE_SIZE
+#endif
+
+// Decimal digits gained per term of atan(1/5) and atan(1/239), times 1000
+#define DIGITS_PER_TERM_5     1398
+#define DIGITS_PER_TERM_239   4757
+
+typedef enum {
+	Phase_Series,
+	Phase_Convert,
+	Phase_Done
+} machinPhase_e;
+
+static mpLimb_t *const sum = (mpLimb_t *) engineWorkspace;
+static mpLimb_t *const power5 = (mpLimb_t *) engineWorkspace + MACHIN_LIMBS;
+static mpLimb_t *const power239 = (mpLimb_t *) engineWorkspace + 2 * MACHIN_LIMBS;
+static mpLimb_t *const term = (mpLimb_t *) engineWorkspace + 3 * MACHIN_LIMBS;
+
+static machinPhase_e phase;
+static uint16_t k5;
+static uint16_t k239;
+static bool done5;
+static bool done239;
+static float tail5;                // 16 / 5^(2k+1), first omitted term
+static float tail239;              // 4 / 239^(2k+1)
+static float estimate;
+static uint16_t released;
+static char latest[ENGINE_LATEST_DIGITS];
+
+static void machinInit(void) {
+	mpSetInt(sum, MACHIN_LIMBS, 0);
+	mpSetInt(power5, MACHIN_LIMBS, 16);
+	mpDivSmall(power5, MACHIN_LIMBS, 5);
+	mpSetInt(power239, MACHIN_LIMBS, 4);
+	mpDivSmall(power239, MACHIN_LIMBS, 239);
+	
+	engineClearDigits(latest);
+	phase = Phase_Series;
+	k5 = 0;
+	k239 = 0;
+	done5 = false;
+	done239 = false;
+	tail5 = 16.0 / 5;
+	tail239 = 4.0 / 239;
+	estimate = 0;
+	released = 0;
+}
+
+// Adds the next term of 16 atan(1/5) or 4 atan(1/239) = sum (-1)^k p / (2k+1)
+// with p = scale / x^(2k+1). Returns true once the power vanished.
+static bool machinTerm(mpLimb_t *power, uint16_t k, uint16_t xSquare, bool negate) {
+	mpDivSmallTo(term, power, MACHIN_LIMBS, 2 * k + 1);
+	if ((k & 1) != negate) {
+		mpSub(sum, term, MACHIN_LIMBS);
+	} else {
+		mpAdd(sum, term, MACHIN_LIMBS);
+	}
+	mpDivSmall(power, MACHIN_LIMBS, xSquare);
+	
+	return mpIsZero(power, MACHIN_LIMBS);
+}
+
+// pi = 16 atan(1/5) - 4 atan(1/239). The series step that lags behind in
+// correct digits is advanced, so the estimate improves steadily. Once both
+// have converged the sum is converted to decimal, one digit per step.
+static uint16_t machinStepBatch(uint16_t steps) {
+	uint16_t done;
+	
+	for (done = 0; done < steps && phase != Phase_Done; done++) {
+		if (phase == Phase_Series) {
+			if (!done5 && (done239 || (uint32_t) k5 * DIGITS_PER_TERM_5 <= (uint32_t) k239 * DIGITS_PER_TERM_239)) {
+				done5 = machinTerm(power5, k5, 25, false);
+				k5++;
+				tail5 = tail5 / 25 * (2 * k5 - 1) / (2 * k5 + 1);
+			} else {
+				done239 = machinTerm(power239, k239, 57121, true);
+				k239++;
+				tail239 = tail239 / 57121 * (2 * k239 - 1) / (2 * k239 + 1);
+			}
+			estimate = mpToFloat(sum, MACHIN_LIMBS);
+			
+			if (done5 && done239) {
+				phase = Phase_Convert;
+				tail5 = 0;
+				tail239 = 0;
+			}
+		} else {
+			// Emit the integer limb and shift the next decimal digit into it
+			engineShiftDigit(latest, '0' + sum[0]);
+			sum[0] = 0;
+			mpMulSmall(sum, MACHIN_LIMBS, 10);
+			released++;
+			
+			if (released == MACHIN_DIGITS) {
+				phase = Phase_Done;
+			}
+		}
+	}
+	
+	return done;
+}
+
+static float machinEstimate(void) {
+	return estimate;
+}
+
+// Both tails plus the reading of the sum: mpToFloat() cuts it after three
+// limbs, below 2^-32, and rounds those to a float
+static float machinErrorBound(void) {
+	return tail5 + tail239 + ldexp(1.0, -32) + engineHalfUlp(estimate);
+}
+
+static uint16_t machinDigits(char *buffer) {
+	engineCopyDigits(buffer, latest);
+	
+	return released;
+}
+
+ENGINE_CONST piEngine_t machinEngine = {
+	.name = "Machin",
+	.termsPerStep = 1,
+	.batchLimit = 16,
+	.convergence = Convergence_Measured,
+	.maxDigits = MACHIN_DIGITS,
+	.init = machinInit,
+	.stepBatch = machinStepBatch,
+	.estimate = machinEstimate,
+	.errorBound = machinErrorBound,
+	.digits = machinDigits,
+};
@@ -0,0 +1,110 @@
+/*
+ * engine_montecarlo.c
+ *
+ * Created: 18.10.2026 17:12:04
+ */ 
+
+
+#include <math.h>
+#include "pi_engine.h"
+
+#define MONTE_CARLO_SEED  2463534242UL
+// Two sided 95% quantile of the normal distribution
+#define CONFIDENCE_Z      1.959964
+
+static uint32_t state;
+static uint32_t samples;
+static uint32_t inside;
+
+// Marsaglia's xorshift32, period 2^32 - 1
+static inline uint32_t xorshift32(void) {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+static void monteCarloInit(void) {
+	state = MONTE_CARLO_SEED;
+	samples = 0;
+	inside = 0;
+}
+
+// One random point per step. x and y are 15 bit and the point is taken in
+// the middle of its grid cell, (2x+1)^2 + (2y+1)^2 < 2^32, which removes
+// most of the bias of the grid. The sum of the two squares wraps around in
+// 32 bits exactly when it reaches 2^32, so no soft-float and no 64-bit
+// arithmetic is needed.
+static uint16_t monteCarloStepBatch(uint16_t steps) {
+	uint16_t k;
+	uint32_t random;
+	uint16_t x;
+	uint16_t y;
+	uint32_t square;
+	uint32_t sum;
+
+	for (k = 0; k < steps; k++) {
+		random = xorshift32();
+		x = ((uint16_t) (random >> 16) & 0xfffe) | 1;
+		y = ((uint16_t) random & 0xfffe) | 1;
+
+		square = (uint32_t) x * x;
+		sum = square + (uint32_t) y * y;
+		if (sum >= square) {
+			inside++;
+		}
+	}
+	samples += steps;
+
+	return steps;
+}
+
+static float monteCarloEstimate(void) {
+	if (samples == 0) {
+		return 0;
+	}
+	return 4.0 * inside / samples;
+}
+
+// A random estimate has no hard bound other than the range [0, 4]
+static float monteCarloErrorBound(void) {
+	return 4.0;
+}
+
+// 1.96 standard deviations of 4 times a binomial ratio
+static float monteCarloConfidence(void) {
+	float p;
+
+	if (samples == 0) {
+		return 4.0;
+	}
+	p = (float) inside / samples;
+	return CONFIDENCE_Z * 4 * sqrt(p * (1 - p) / samples);
+}
+
+// Checkpoints (12 bytes)
+static void monteCarloSaveState(uint8_t *buffer) {
+	buffer = engineSaveValue(buffer, &state, sizeof(state));
+	buffer = engineSaveValue(buffer, &samples, sizeof(samples));
+	engineSaveValue(buffer, &inside, sizeof(inside));
+}
+
+static void monteCarloLoadState(const uint8_t *buffer) {
+	buffer = engineLoadValue(buffer, &state, sizeof(state));
+	buffer = engineLoadValue(buffer, &samples, sizeof(samples));
+	engineLoadValue(buffer, &inside, sizeof(inside));
+}
+
+ENGINE_CONST piEngine_t monteCarloEngine = {
+	.name = "Monte Carlo",
+	.termsPerStep = 1,
+	.convergence = Convergence_None,
+	.maxDigits = 0,
+	.init = monteCarloInit,
+	.stepBatch = monteCarloStepBatch,
+	.estimate = monteCarloEstimate,
+	.errorBound = monteCarloErrorBound,
+	.confidence = monteCarloConfidence,
+	.saveState = monteCarloSaveState,
+	.loadState = monteCarloLoadState,
+};
@@ -0,0 +1,102 @@
+/*
+ * engine_nilakantha.c
+ *
+ * Created: 18.10.2026 17:48:31
+ */ 
+
+#include <math.h>
+#include "pi_engine.h"
+#include "ff_math.h"
+
+// Worst case rounding error one step adds: a float-float addition to a
+// sum below 0.142 of a term below 0.134, both off by less than 2^-45
+// relative
+#define NILAKANTHA_STEP_ROUNDING  8e-15
+
+static ffFloat_t ffSum;
+static uint32_t i;
+
+// Denominator start d = 2 + 4i of the next pair of terms
+static uint32_t nilakanthaDenom(void) {
+	return 2 + 4 * i;
+}
+
+// pi = 3 + 4/(2*3*4) - 4/(4*5*6) + 4/(6*7*8) - ...
+static void nilakanthaInit(void) {
+	ffSum = ffFromFloat(0.0);
+	i = 0;
+}
+
+// Alternating series, the exact partial sum is off by less than the
+// first omitted term 4/(d(d+1)(d+2))
+static float nilakanthaTailBound(void) {
+	float d = nilakanthaDenom();
+	
+	return 4.0 / (d * (d + 1) * (d + 2));
+}
+
+// Error of 3 plus the float-float sum
+static float nilakanthaSumBound(void) {
+	return nilakanthaTailBound() + i * NILAKANTHA_STEP_ROUNDING;
+}
+
+// One step adds a pair of terms, 4/(d(d+1)(d+2)) - 4/((d+2)(d+3)(d+4))
+// = 24/(d(d+1)(d+3)(d+4)) = 24/(m(m+3)) with m = d^2 + 4d. The pairs are
+// positive, so the sum of the corrections to 3 never cancels. Once the
+// tail falls below the rounding of the steps so far, further steps only
+// widen the error bound and the engine is finished. That is checked on
+// every step, a batch may end there: it happens near i = 1700, long
+// before m + 3 overflows 32 bits at i = 16383.
+static uint16_t nilakanthaStepBatch(uint16_t steps) {
+	uint16_t k;
+	uint32_t d;
+	uint32_t m;
+	
+	for (k = 0; k < steps && nilakanthaTailBound() >= i * NILAKANTHA_STEP_ROUNDING; k++) {
+		d = nilakanthaDenom();
+		m = d * d + 4 * d;
+		ffSum = ffAdd(ffSum, ffDiv(ffFromFloat(24.0), ffMul(ffFromUint32(m), ffFromUint32(m + 3))));
+		i++;
+	}
+	
+	return k;
+}
+
+static float nilakanthaEstimate(void) {
+	return 3 + ffSum.hi;
+}
+
+// The estimate drops ffSum.lo and rounds 3 + ffSum.hi to a float
+static float nilakanthaErrorBound(void) {
+	return nilakanthaSumBound() + fabs(ffSum.lo) + engineHalfUlp(nilakanthaEstimate());
+}
+
+// The digits the float-float sum guarantees
+static uint16_t nilakanthaDigits(char *latest) {
+	return engineIntervalDigits(ffAdd(ffFromFloat(3.0), ffSum), nilakanthaSumBound(), latest, FF_DIGITS);
+}
+
+// Checkpoints (12 bytes)
+static void nilakanthaSaveState(uint8_t *state) {
+	state = engineSaveValue(state, &ffSum, sizeof(ffSum));
+	engineSaveValue(state, &i, sizeof(i));
+}
+
+static void nilakanthaLoadState(const uint8_t *state) {
+	state = engineLoadValue(state, &ffSum, sizeof(ffSum));
+	engineLoadValue(state, &i, sizeof(i));
+}
+
+ENGINE_CONST piEngine_t nilakanthaEngine = {
+	.name = "Nilakantha",
+	.termsPerStep = 2,
+	.convergence = Convergence_Measured,
+	.maxDigits = 10,
+	.init = nilakanthaInit,
+	.stepBatch = nilakanthaStepBatch,
+	.estimate = nilakanthaEstimate,
+	.errorBound = nilakanthaErrorBound,
+	.digits = nilakanthaDigits,
+	.saveState = nilakanthaSaveState,
+	.loadState = nilakanthaLoadState,
+};
@@ -0,0 +1,196 @@
+/*
+ * engine_ramanujan.c
+ *
+ * Created: 18.10.2026 18:05:12
+ */ 
+
+#include "pi_engine.h"
+#include "mp_math.h"
+
+// Decimal digits produced, including the leading 3. Six numbers of
+// RAMANUJAN_LIMBS limbs each are kept in the shared engine workspace.
+#ifndef RAMANUJAN_DIGITS
+#define RAMANUJAN_DIGITS     1000
+#endif
+// One more guard limb than usual: the final 9801 / sqrt(8) / S scales the
+// truncation errors of the square root and the reciprocal up by about 2^13
+#define RAMANUJAN_LIMBS      (MP_LIMBS_FOR_DIGITS(RAMANUJAN_DIGITS) + 1)
+
+#if RAMANUJAN_LIMBS * 6 * 2 > ENGINE_WORKSPACE_SIZE
+#error RAMANUJAN_DIGITS too large for ENGINE_WORKSPACE_SIZE
+#endif
+
+// 1/pi = sqrt(8) / 9801 * sum (4k)! (1103 + 26390k) / (k!^4 396^4k)
+#define RAMANUJAN_A          1103
+#define RAMANUJAN_B          26390
+#define RAMANUJAN_BASE       396
+#define RAMANUJAN_NUMERATOR  9801
+#define RAMANUJAN_SQRT8      2.8284271
+#define RAMANUJAN_PI         3.1415927
+
+typedef enum {
+	Phase_Series,
+	Phase_Root,
+	Phase_Divide,
+	Phase_Convert,
+	Phase_Done
+} ramanujanPhase_e;
+
+// sum t_k and sum k t_k with t_k = (4k)! / (k!^4 396^4k), combined into
+// S = 1103 a + 26390 b once the series has converged
+static mpLimb_t *const a = (mpLimb_t *) engineWorkspace;
+static mpLimb_t *const b = (mpLimb_t *) engineWorkspace + RAMANUJAN_LIMBS;
+static mpLimb_t *const term = (mpLimb_t *) engineWorkspace + 2 * RAMANUJAN_LIMBS;
+// Three blocks for the square root and the division, the first of them
+// holds k t_k while summing
+static mpLimb_t *const scratch = (mpLimb_t *) engineWorkspace + 3 * RAMANUJAN_LIMBS;
+
+static ramanujanPhase_e phase;
+static uint16_t k;
+static float tail;                 // t_k as a float, 0 once it underflowed
+static float estimate;
+static uint16_t released;
+static char latest[ENGINE_LATEST_DIGITS];
+
+static void ramanujanInit(void) {
+	mpSetInt(a, RAMANUJAN_LIMBS, 1);
+	mpSetInt(b, RAMANUJAN_LIMBS, 0);
+	mpSetInt(term, RAMANUJAN_LIMBS, 1);
+	
+	engineClearDigits(latest);
+	phase = Phase_Series;
+	k = 0;
+	tail = 1.0;
+	estimate = RAMANUJAN_NUMERATOR / (RAMANUJAN_SQRT8 * RAMANUJAN_A);
+	released = 0;
+}
+
+// t_k = t_(k-1) * 8 (4k-3) (2k-1) (4k-1) / (k^3 396^4). The factors go
+// first, they are exact and keep the term below 1, while every division
+// truncates by less than one unit of the last limb.
+static void ramanujanTerm(void) {
+	uint8_t j;
+	
+	k++;
+	mpMulSmall(term, RAMANUJAN_LIMBS, 8 * (4 * k - 3));
+	mpMulSmall(term, RAMANUJAN_LIMBS, 2 * k - 1);
+	mpMulSmall(term, RAMANUJAN_LIMBS, 4 * k - 1);
+	for (j = 0; j < 3; j++) {
+		mpDivSmall(term, RAMANUJAN_LIMBS, k);
+	}
+	for (j = 0; j < 4; j++) {
+		mpDivSmall(term, RAMANUJAN_LIMBS, RAMANUJAN_BASE);
+	}
+	mpAdd(a, term, RAMANUJAN_LIMBS);
+	mpCopy(scratch, term, RAMANUJAN_LIMBS);
+	mpMulSmall(scratch, RAMANUJAN_LIMBS, k);
+	mpAdd(b, scratch, RAMANUJAN_LIMBS);
+	
+	tail = tail * 8 * (4 * k + 1) * (2 * k + 1) * (4 * k + 3) / ((float) (k + 1) * (k + 1) * (k + 1));
+	for (j = 0; j < 4; j++) {
+		tail /= RAMANUJAN_BASE;
+	}
+}
+
+// 9801 / (sqrt(8) S) from the leading limbs
+static float ramanujanFloatEstimate(void) {
+	float sum = RAMANUJAN_A * mpToFloat(a, RAMANUJAN_LIMBS) + RAMANUJAN_B * mpToFloat(b, RAMANUJAN_LIMBS);
+	
+	return RAMANUJAN_NUMERATOR / (RAMANUJAN_SQRT8 * sum);
+}
+
+// A step is one term of the series (about 8 digits), the square root, the
+// final division or one decimal digit. A batch ends with the step that
+// changes the phase, so drivers can time the phases separately.
+static uint16_t ramanujanStepBatch(uint16_t steps) {
+	ramanujanPhase_e entered;
+	uint16_t done = 0;
+	
+	while (done < steps && phase != Phase_Done) {
+		entered = phase;
+		switch (phase) {
+			case Phase_Series:
+				ramanujanTerm();
+				estimate = ramanujanFloatEstimate();
+				if (mpIsZero(term, RAMANUJAN_LIMBS)) {
+					// S = 1103 a + 26390 b, left in a
+					mpMulSmall(a, RAMANUJAN_LIMBS, RAMANUJAN_A);
+					mpMulSmall(b, RAMANUJAN_LIMBS, RAMANUJAN_B);
+					mpAdd(a, b, RAMANUJAN_LIMBS);
+					tail = 0;
+					phase = Phase_Root;
+				}
+				break;
+				
+			case Phase_Root:
+				// 9801 / sqrt(8), left in term
+				mpSetInt(b, RAMANUJAN_LIMBS, 8);
+				mpInvSqrt(term, b, RAMANUJAN_LIMBS, scratch);
+				mpMulSmall(term, RAMANUJAN_LIMBS, RAMANUJAN_NUMERATOR);
+				phase = Phase_Divide;
+				break;
+				
+			case Phase_Divide:
+				// pi, left in b
+				mpDiv(b, term, a, RAMANUJAN_LIMBS, scratch);
+				phase = Phase_Convert;
+				break;
+				
+			default:
+				// Emit the integer limb and shift the next decimal digit into it
+				engineShiftDigit(latest, '0' + b[0]);
+				b[0] = 0;
+				mpMulSmall(b, RAMANUJAN_LIMBS, 10);
+				released++;
+				if (released == RAMANUJAN_DIGITS) {
+					phase = Phase_Done;
+				}
+				break;
+		}
+		done++;
+		if (phase != entered) {
+			break;
+		}
+	}
+	
+	return done;
+}
+
+static float ramanujanEstimate(void) {
+	return estimate;
+}
+
+// The omitted terms change S by less than 1.01 times the first of them,
+// t_k (1103 + 26390k), and pi by that relative to S. Plus the rounding of
+// the float estimate.
+static float ramanujanErrorBound(void) {
+	float omitted = 1.01 * tail * (RAMANUJAN_A + (float) RAMANUJAN_B * k);
+	
+	return RAMANUJAN_PI * omitted / RAMANUJAN_A + 4 * engineHalfUlp(estimate);
+}
+
+static uint16_t ramanujanDigits(char *buffer) {
+	engineCopyDigits(buffer, latest);
+	
+	return released;
+}
+
+static const char *ramanujanPhaseName(void) {
+	static const char *const names[] = { "series", "sqrt", "division", "conversion", "done" };
+	
+	return names[phase];
+}
+
+ENGINE_CONST piEngine_t ramanujanEngine = {
+	.name = "Ramanujan",
+	.termsPerStep = 1,
+	.batchLimit = 16,
+	.convergence = Convergence_Measured,
+	.maxDigits = RAMANUJAN_DIGITS,
+	.init = ramanujanInit,
+	.stepBatch = ramanujanStepBatch,
+	.estimate = ramanujanEstimate,
+	.errorBound = ramanujanErrorBound,
+	.digits = ramanujanDigits,
+	.phaseName = ramanujanPhaseName,
+};
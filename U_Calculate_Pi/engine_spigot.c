@@ -0,0 +1,147 @@
+/*
+ * engine_spigot.c
+ *
+ * Created: 17.10.2026 11:20:09
+ */ 
+
+#include "pi_engine.h"
+
+// Number of decimal digits the spigot produces. Its working array takes
+// about 10/3 16-bit words per digit of the shared engine workspace.
+#ifndef SPIGOT_DIGITS
+#define SPIGOT_DIGITS     375
+#endif
+// Extra digits computed past the target, the last few spigot digits
+// are not reliable
+#define SPIGOT_GUARD      4
+#define SPIGOT_LENGTH     (10UL * (SPIGOT_DIGITS + SPIGOT_GUARD) / 3 + 2)
+
+#if SPIGOT_LENGTH * 2 > ENGINE_WORKSPACE_SIZE
+#error SPIGOT_DIGITS too large for ENGINE_WORKSPACE_SIZE
+#endif
+
+// Digits of the estimate, more do not fit into a float anyway
+#define ESTIMATE_DIGITS   9
+
+static uint16_t *const remainders = (uint16_t *) engineWorkspace;
+static uint16_t produced;          // digits computed by the spigot
+static uint16_t released;          // digits known to be final
+static uint8_t predigit;
+static uint8_t nines;
+static uint32_t leading;           // first ESTIMATE_DIGITS digits
+static uint32_t leadingScale;
+static char latest[ENGINE_LATEST_DIGITS];
+
+static void releaseDigit(uint8_t digit) {
+	if (released >= SPIGOT_DIGITS) {
+		return;
+	}
+	
+	engineShiftDigit(latest, '0' + digit);
+	
+	if (released < ESTIMATE_DIGITS) {
+		leading = leading * 10 + digit;
+		if (released > 0) {
+			leadingScale *= 10;
+		}
+	}
+	released++;
+}
+
+// Rabinowitz-Wagon: pi = 2 + 1/3 (2 + 2/5 (2 + 3/7 (2 + ...))) is kept as
+// a mixed radix number. Multiplying it by 10 and normalising from the back
+// yields the next decimal digit in front. A digit can still be changed by a
+// carry as long as it is followed by nines, so those are held back.
+static void spigotInit(void) {
+	uint16_t j;
+	
+	for (j = 0; j < SPIGOT_LENGTH; j++) {
+		remainders[j] = 2;
+	}
+	engineClearDigits(latest);
+	produced = 0;
+	released = 0;
+	predigit = 0;
+	nines = 0;
+	leading = 0;
+	leadingScale = 1;
+}
+
+static uint16_t spigotStepBatch(uint16_t steps) {
+	uint16_t k;
+	uint16_t j;
+	uint16_t length;
+	uint16_t denominator;
+	uint32_t x;
+	uint16_t q;
+	
+	for (k = 0; k < steps && released < SPIGOT_DIGITS && produced < SPIGOT_DIGITS + SPIGOT_GUARD; k++) {
+		// The tail of the mixed radix number only influences the digits that
+		// are still to come, so the working length shrinks with every digit
+		length = 10UL * (SPIGOT_DIGITS + SPIGOT_GUARD - produced) / 3 + 2;
+		q = 0;
+		
+		for (j = length - 1; j > 0; j--) {
+			denominator = 2 * j + 1;
+			x = 10UL * remainders[j] + (uint32_t) q * (j + 1);
+			q = x / denominator;
+			remainders[j] = x - (uint32_t) q * denominator;
+		}
+		x = 10UL * remainders[0] + q;
+		q = x / 10;
+		remainders[0] = x % 10;
+		produced++;
+		
+		if (q == 9) {
+			nines++;
+		} else if (q == 10) {
+			releaseDigit(predigit + 1);
+			for (; nines > 0; nines--) {
+				releaseDigit(0);
+			}
+			predigit = 0;
+		} else {
+			if (produced > 1) {
+				releaseDigit(predigit);
+			}
+			for (; nines > 0; nines--) {
+				releaseDigit(9);
+			}
+			predigit = q;
+		}
+	}
+	
+	return k;
+}
+
+static float spigotEstimate(void) {
+	return (float) leading / leadingScale;
+}
+
+// All released digits are exact, only the ones after them are unknown.
+// The division in spigotEstimate() rounds on top of that.
+static float spigotErrorBound(void) {
+	if (released == 0) {
+		return 4.0;
+	}
+	return 1.0 / leadingScale + engineHalfUlp(spigotEstimate());
+}
+
+static uint16_t spigotDigits(char *buffer) {
+	engineCopyDigits(buffer, latest);
+	
+	return released;
+}
+
+ENGINE_CONST piEngine_t spigotEngine = {
+	.name = "Spigot",
+	.termsPerStep = 1,
+	.batchLimit = 8,
+	.convergence = Convergence_Measured,
+	.maxDigits = SPIGOT_DIGITS,
+	.init = spigotInit,
+	.stepBatch = spigotStepBatch,
+	.estimate = spigotEstimate,
+	.errorBound = spigotErrorBound,
+	.digits = spigotDigits,
+};
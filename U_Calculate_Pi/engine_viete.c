@@ -0,0 +1,106 @@
+/*
+ * engine_viete.c
+ *
+ * Created: 18.10.2026 18:41:27
+ */ 
+
+#include "pi_engine.h"
+#include "mp_math.h"
+#include "ff_math.h"
+
+// 2^32 as a float, the scale of the Q0.32 numbers
+#define Q32_ONE             4294967296.0
+#define VIETE_PI            3.1415927
+// Relative error one factor adds to the product: the root is truncated by
+// less than one unit and the errors of the earlier roots shrink to a
+// quarter per factor (at most 4/3 units in c), the product is truncated by
+// one unit more. Relative to c > 0.7 and P > 0.63, rounded up: 5 units.
+#define FACTOR_ROUNDING     (5 / Q32_ONE)
+
+// c = cos(pi / 2^(k+1)) and the product P of these factors, both Q0.32
+static uint32_t cosine;
+static uint32_t product;
+static uint8_t k;
+
+// 2/pi = sqrt(2)/2 * sqrt(2 + sqrt(2))/2 * ..., the factors are the
+// cosines c_k with c_(k+1) = sqrt((1 + c_k) / 2). The first is set here,
+// P = c_1 = sqrt(1/2).
+static void vieteInit(void) {
+	cosine = ulSqrt64(1ULL << 63);
+	product = cosine;
+	k = 1;
+}
+
+// P_k = 1 / (2^k sin t) with t = pi / 2^(k+1), so 2 / P_k = pi sin(t) / t
+// is below pi by less than pi t^2 / 6
+static float vieteTailBound(void) {
+	float t = VIETE_PI / (2UL << k);
+	
+	return VIETE_PI * t * t / 6;
+}
+
+// Tail plus the rounding of all factors, relative to pi
+static float vieteBound(void) {
+	return vieteTailBound() + VIETE_PI * k * FACTOR_ROUNDING;
+}
+
+static float vieteEstimate(void) {
+	return 2 * Q32_ONE / product;
+}
+
+static float vieteErrorBound(void) {
+	return vieteBound() + engineHalfUlp(vieteEstimate());
+}
+
+// One factor per step: a 64-bit integer square root and a 32x32 bit
+// multiplication. (1 + c) / 2 is Q0.64 and its root Q0.32 again. Every
+// factor quarters the tail, so after a dozen of them the rounding
+// dominates and further factors would only widen the bound.
+static uint16_t vieteStepBatch(uint16_t steps) {
+	uint16_t done;
+	
+	for (done = 0; done < steps; done++) {
+		if (vieteTailBound() < VIETE_PI * k * FACTOR_ROUNDING) {
+			break;
+		}
+		cosine = ulSqrt64(((uint64_t) cosine + (1ULL << 32)) << 31);
+		product = ((uint64_t) product * cosine) >> 32;
+		k++;
+	}
+	
+	return done;
+}
+
+// The digits the error bound guarantees, from 2 / P in float-float
+static uint16_t vieteDigits(char *latest) {
+	ffFloat_t value = ffDiv(ffFromFloat(2 * Q32_ONE), ffFromUint32(product));
+	
+	return engineIntervalDigits(value, vieteBound(), latest, FF_DIGITS);
+}
+
+// Checkpoints (9 bytes)
+static void vieteSaveState(uint8_t *state) {
+	state = engineSaveValue(state, &cosine, sizeof(cosine));
+	state = engineSaveValue(state, &product, sizeof(product));
+	engineSaveValue(state, &k, sizeof(k));
+}
+
+static void vieteLoadState(const uint8_t *state) {
+	state = engineLoadValue(state, &cosine, sizeof(cosine));
+	state = engineLoadValue(state, &product, sizeof(product));
+	engineLoadValue(state, &k, sizeof(k));
+}
+
+ENGINE_CONST piEngine_t vieteEngine = {
+	.name = "Viete",
+	.termsPerStep = 1,
+	.convergence = Convergence_Linear,
+	.maxDigits = 7,
+	.init = vieteInit,
+	.stepBatch = vieteStepBatch,
+	.estimate = vieteEstimate,
+	.errorBound = vieteErrorBound,
+	.digits = vieteDigits,
+	.saveState = vieteSaveState,
+	.loadState = vieteLoadState,
+};
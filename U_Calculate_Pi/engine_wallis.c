@@ -0,0 +1,250 @@
+/*
+ * engine_wallis.c
+ *
+ * Created: 17.10.2026 10:07:12
+ */ 
+
+#include "pi_engine.h"
+#include "ff_math.h"
+#include "recip_math.h"
+
+// Worst case rounding error one float-float step adds to the estimate
+#define FF_STEP_ROUNDING    1e-13
+// Relative error of one term of the compensated engines: the conversion
+// and square of i, product + compensation and the division
+#define TERM_ROUNDING       (4 * ENGINE_ROUNDOFF)
+// Odd numbers below this have their square in 32 bits
+#define SQUARE_EXACT_ODD    65536UL
+
+static float product;
+static float i;
+static uint32_t factors;
+static float compensation;
+static ffFloat_t ffProduct;
+static uint32_t odd;
+
+// pi = 4 * (2/3 * 4/3) * (4/5 * 6/5) * ...
+static void wallisInit(void) {
+	product = 4.0;
+	i = 3.0;
+	factors = 0;
+}
+
+static uint16_t wallisStepBatch(uint16_t steps) {
+	uint16_t k;
+	
+	for (k = 0; k < steps; k++) {
+		product = product * ((i - 1) / i) * ((i + 1) / i);
+		i += 2;
+	}
+	factors += steps;
+	
+	return steps;
+}
+
+static float wallisEstimate(void) {
+	return product;
+}
+
+// The remaining factors multiply to exp(x) with x < 1/(4(n+1)), so the
+// product exceeds pi by less than product * x / (1 - x) = product / (4n+3)
+static float wallisTailBound(void) {
+	return product / (4.0 * factors + 3);
+}
+
+// Tail plus the rounding of two divisions and two multiplications per
+// factor, which compound to a relative error of at most 4nu / (1 - 4nu)
+static float wallisErrorBound(void) {
+	float relative = 4 * factors * ENGINE_ROUNDOFF;
+	
+	if (relative >= 0.5) {
+		return product;
+	}
+	return wallisTailBound() + product * relative / (1 - relative);
+}
+
+//----------------------------------------------
+// compensated engine, each factor (i^2 - 1) / i^2 = 1 - 1/i^2 turns the
+// product into the sum product - product / i^2 with Kahan summation
+//
+static void wallisCompensatedInit(void) {
+	wallisInit();
+	compensation = 0.0;
+}
+
+static float wallisCompensatedEstimate(void) {
+	return product + compensation;
+}
+
+static uint16_t wallisCompensatedStepBatch(uint16_t steps) {
+	uint16_t k;
+	
+	// Finished once the remaining factors can no longer change the float result
+	if (wallisTailBound() < engineHalfUlp(wallisCompensatedEstimate())) {
+		return 0;
+	}
+	
+	for (k = 0; k < steps; k++) {
+		engineCompensatedAdd(&product, &compensation, -(product + compensation) / (i * i));
+		i += 2;
+	}
+	factors += steps;
+	
+	return steps;
+}
+
+// The terms add up to 4 - pi < 1 and the factors (1 - 1/i^2) only shrink
+// the errors of earlier steps, so the Kahan bound with magnitude 1 holds
+static float wallisCompensatedErrorBound(void) {
+	float rounding = engineKahanRounding(factors, 1.0) + TERM_ROUNDING;
+	
+	return wallisTailBound() + rounding + engineHalfUlp(wallisCompensatedEstimate());
+}
+
+//----------------------------------------------
+// integer index engine, the compensated kernel with the index kept in a
+// uint32_t. It stays exact past 2^24 where the float i starts to skip odd
+// numbers. While i^2 fits into 32 bits a factor is a multiplication with
+// the rounded reciprocal of the exact i^2, two roundings like the square
+// and the division it replaces. Past that a factor costs a single division.
+//
+static void wallisIntegerInit(void) {
+	wallisCompensatedInit();
+	odd = 3;
+}
+
+static uint16_t wallisIntegerStepBatch(uint16_t steps) {
+	uint16_t k;
+	float square;
+	
+	for (k = 0; k < steps; k++) {
+		if (odd < SQUARE_EXACT_ODD) {
+			engineCompensatedAdd(&product, &compensation, -(product + compensation) * fReciprocal(odd * odd));
+		} else {
+			// One conversion, the rounding of i^2 only touches the tiny term
+			square = odd;
+			square *= square;
+			engineCompensatedAdd(&product, &compensation, -(product + compensation) / square);
+		}
+		odd += 2;
+	}
+	factors += steps;
+	
+	return steps;
+}
+
+//----------------------------------------------
+// float-float engine, product - product / i^2 like the compensated one.
+// i^2 stays exact as a float-float product up to i = 2^24.
+//
+static void wallisFloatFloatInit(void) {
+	ffProduct = ffFromFloat(4.0);
+	odd = 3;
+	factors = 0;
+}
+
+static uint16_t wallisFloatFloatStepBatch(uint16_t steps) {
+	uint16_t k;
+	
+	for (k = 0; k < steps; k++) {
+		ffProduct = ffSub(ffProduct, ffDiv(ffProduct, ffTwoProd(odd, odd)));
+		odd += 2;
+	}
+	factors += steps;
+	
+	return steps;
+}
+
+static float wallisFloatFloatEstimate(void) {
+	return ffProduct.hi;
+}
+
+// Remaining factors plus the rounding of every step so far, the error of
+// the float-float product
+static float wallisFloatFloatProductBound(void) {
+	return ffProduct.hi / (4.0 * factors + 3) + factors * FF_STEP_ROUNDING;
+}
+
+// The estimate is the product rounded to a float
+static float wallisFloatFloatErrorBound(void) {
+	return wallisFloatFloatProductBound() + engineHalfUlp(ffProduct.hi);
+}
+
+// The digits the float-float product guarantees
+static uint16_t wallisFloatFloatDigits(char *latest) {
+	return engineIntervalDigits(ffProduct, wallisFloatFloatProductBound(), latest, FF_DIGITS);
+}
+
+//----------------------------------------------
+// checkpoints, one state for all engines of this file (28 bytes)
+//
+static void wallisSaveState(uint8_t *state) {
+	state = engineSaveValue(state, &product, sizeof(product));
+	state = engineSaveValue(state, &i, sizeof(i));
+	state = engineSaveValue(state, &factors, sizeof(factors));
+	state = engineSaveValue(state, &compensation, sizeof(compensation));
+	state = engineSaveValue(state, &ffProduct, sizeof(ffProduct));
+	engineSaveValue(state, &odd, sizeof(odd));
+}
+
+static void wallisLoadState(const uint8_t *state) {
+	state = engineLoadValue(state, &product, sizeof(product));
+	state = engineLoadValue(state, &i, sizeof(i));
+	state = engineLoadValue(state, &factors, sizeof(factors));
+	state = engineLoadValue(state, &compensation, sizeof(compensation));
+	state = engineLoadValue(state, &ffProduct, sizeof(ffProduct));
+	engineLoadValue(state, &odd, sizeof(odd));
+}
+
+ENGINE_CONST piEngine_t wallisEngine = {
+	.name = "Wallis",
+	.termsPerStep = 1,
+	.convergence = Convergence_Algebraic,
+	.maxDigits = 3,
+	.init = wallisInit,
+	.stepBatch = wallisStepBatch,
+	.estimate = wallisEstimate,
+	.errorBound = wallisErrorBound,
+	.saveState = wallisSaveState,
+	.loadState = wallisLoadState,
+};
+
+ENGINE_CONST piEngine_t wallisCompensatedEngine = {
+	.name = "Wallis Cmp",
+	.termsPerStep = 1,
+	.convergence = Convergence_Algebraic,
+	.maxDigits = 6,
+	.init = wallisCompensatedInit,
+	.stepBatch = wallisCompensatedStepBatch,
+	.estimate = wallisCompensatedEstimate,
+	.errorBound = wallisCompensatedErrorBound,
+	.saveState = wallisSaveState,
+	.loadState = wallisLoadState,
+};
+
+ENGINE_CONST piEngine_t wallisIntegerEngine = {
+	.name = "Wallis Int",
+	.termsPerStep = 1,
+	.convergence = Convergence_Algebraic,
+	.maxDigits = 6,
+	.init = wallisIntegerInit,
+	.stepBatch = wallisIntegerStepBatch,
+	.estimate = wallisCompensatedEstimate,
+	.errorBound = wallisCompensatedErrorBound,
+	.saveState = wallisSaveState,
+	.loadState = wallisLoadState,
+};
+
+ENGINE_CONST piEngine_t wallisFloatFloatEngine = {
+	.name = "Wallis FF",
+	.termsPerStep = 1,
+	.convergence = Convergence_Algebraic,
+	.maxDigits = 6,
+	.init = wallisFloatFloatInit,
+	.stepBatch = wallisFloatFloatStepBatch,
+	.estimate = wallisFloatFloatEstimate,
+	.errorBound = wallisFloatFloatErrorBound,
+	.digits = wallisFloatFloatDigits,
+	.saveState = wallisSaveState,
+	.loadState = wallisLoadState,
+};
@@ -0,0 +1,138 @@
+/*
+ * ff_math.c
+ *
+ * Created: 17.10.2026 16:41:05
+ */ 
+
+#include "ff_math.h"
+
+// Veltkamp splitting constant 2^12 + 1, cuts a 24 bit mantissa into
+// two halves whose products are exact in float
+#define FF_SPLITTER  4097.0
+
+// hi + lo for |a| >= |b|, three operations instead of six
+static inline ffFloat_t ffFastTwoSum(float a, float b) {
+	ffFloat_t r;
+	
+	r.hi = a + b;
+	r.lo = b - (r.hi - a);
+	return r;
+}
+
+static inline void ffSplit(float a, float *hi, float *lo) {
+	float t = FF_SPLITTER * a;
+	
+	*hi = t - (t - a);
+	*lo = a - *hi;
+}
+
+ffFloat_t ffFromFloat(float a) {
+	ffFloat_t r;
+	
+	r.hi = a;
+	r.lo = 0.0;
+	return r;
+}
+
+ffFloat_t ffFromUint32(uint32_t a) {
+	ffFloat_t r;
+	
+	// The conversion rounds to 24 bits, the remainder fits into lo exactly
+	r.hi = (float) a;
+	r.lo = (float) (int32_t) (a - (uint32_t) r.hi);
+	return ffFastTwoSum(r.hi, r.lo);
+}
+
+ffFloat_t ffTwoSum(float a, float b) {
+	ffFloat_t r;
+	float v;
+	
+	r.hi = a + b;
+	v = r.hi - a;
+	r.lo = (a - (r.hi - v)) + (b - v);
+	return r;
+}
+
+// Dekker's product, there is no fused multiply-add to lean on
+ffFloat_t ffTwoProd(float a, float b) {
+	ffFloat_t r;
+	float ah, al, bh, bl;
+	
+	r.hi = a * b;
+	ffSplit(a, &ah, &al);
+	ffSplit(b, &bh, &bl);
+	r.lo = ((ah * bh - r.hi) + ah * bl + al * bh) + al * bl;
+	return r;
+}
+
+ffFloat_t ffAdd(ffFloat_t a, ffFloat_t b) {
+	ffFloat_t s = ffTwoSum(a.hi, b.hi);
+	ffFloat_t t = ffTwoSum(a.lo, b.lo);
+	
+	s.lo += t.hi;
+	s = ffFastTwoSum(s.hi, s.lo);
+	s.lo += t.lo;
+	return ffFastTwoSum(s.hi, s.lo);
+}
+
+ffFloat_t ffSub(ffFloat_t a, ffFloat_t b) {
+	b.hi = -b.hi;
+	b.lo = -b.lo;
+	return ffAdd(a, b);
+}
+
+ffFloat_t ffMul(ffFloat_t a, ffFloat_t b) {
+	ffFloat_t p = ffTwoProd(a.hi, b.hi);
+	
+	p.lo += a.hi * b.lo + a.lo * b.hi;
+	return ffFastTwoSum(p.hi, p.lo);
+}
+
+ffFloat_t ffMulFloat(ffFloat_t a, float b) {
+	ffFloat_t p = ffTwoProd(a.hi, b);
+	
+	p.lo += a.lo * b;
+	return ffFastTwoSum(p.hi, p.lo);
+}
+
+// Long division with float quotient digits: every step removes another
+// 24 bits from the remainder
+ffFloat_t ffDiv(ffFloat_t a, ffFloat_t b) {
+	ffFloat_t q;
+	ffFloat_t r;
+	float q2;
+	
+	q.hi = a.hi / b.hi;
+	r = ffSub(a, ffMulFloat(b, q.hi));
+	q.lo = r.hi / b.hi;
+	r = ffSub(r, ffMulFloat(b, q.lo));
+	q2 = r.hi / b.hi;
+	
+	q = ffFastTwoSum(q.hi, q.lo);
+	return ffAdd(q, ffFromFloat(q2));
+}
+
+// One Newton step y + y * (1 - a * y) from the float reciprocal doubles
+// its 24 correct bits, only one float division is needed
+ffFloat_t ffReciprocal(ffFloat_t a) {
+	ffFloat_t y = ffFromFloat(1.0 / a.hi);
+	ffFloat_t e = ffSub(ffFromFloat(1.0), ffMulFloat(a, y.hi));
+	
+	return ffAdd(y, ffMulFloat(e, y.hi));
+}
+
+// Splits off one decimal digit at a time, a * 10 is exact enough in
+// float-float to keep all FF_DIGITS digits correct
+void ffToDigits(ffFloat_t a, char *digits, uint8_t count) {
+	uint8_t k;
+	int8_t digit;
+	
+	for (k = 0; k < count; k++) {
+		digit = (int8_t) a.hi;
+		if ((float) digit > a.hi || ((float) digit == a.hi && a.lo < 0)) {
+			digit--;
+		}
+		digits[k] = '0' + digit;
+		a = ffMulFloat(ffSub(a, ffFromFloat(digit)), 10.0);
+	}
+}
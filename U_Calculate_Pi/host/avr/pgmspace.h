@@ -0,0 +1,16 @@
+/*
+ * pgmspace.h
+ *
+ * Created: 18.10.2026 14:58:40
+ */ 
+
+
+#ifndef HOST_PGMSPACE_H_
+#define HOST_PGMSPACE_H_
+
+// Flash tables of the shared sources are plain constants on the host
+#define PROGMEM
+#define pgm_read_byte(address)  (*(const unsigned char *) (address))
+#define pgm_read_word(address)  (*(const unsigned short *) (address))
+
+#endif /* HOST_PGMSPACE_H_ */
@@ -0,0 +1,390 @@
+/*
+ * engine_chudnovsky.c
+ *
+ * Created: 18.10.2026 14:35:09
+ */ 
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <gmp.h>
+#include "pi_engine.h"
+#include "engine_chudnovsky.h"
+#include "thread_pool.h"
+
+#define CHUDNOVSKY_DEFAULT_DIGITS  1000000
+#define CHUDNOVSKY_MAX_DIGITS      100000000
+// Every term of the series adds log10(640320^3 / 1728) digits
+#define DIGITS_PER_TERM            14.181647462725477
+// Extra digits carried through the fixed point division and square root
+#define GUARD_DIGITS               16
+// Ranges per thread the series is cut into before the parallel merge,
+// more of them even out the uneven cost of the leaves
+#define LEAVES_PER_THREAD          8
+
+// pi = 426880 sqrt(10005) Q(0,N) / T(0,N) with
+// P(k) = -(6k-5)(2k-1)(6k-1), Q(k) = k^3 640320^3 / 24,
+// T(k) = P(k) (13591409 + 545140134 k), P(0) = Q(0) = 1
+#define CHUDNOVSKY_A               13591409
+#define CHUDNOVSKY_B               545140134
+#define CHUDNOVSKY_C               640320
+#define CHUDNOVSKY_SCALE           426880
+#define CHUDNOVSKY_ROOT            10005
+
+typedef enum {
+	Phase_Series,
+	Phase_Divide,
+	Phase_Sqrt,
+	Phase_Convert,
+	Phase_Done
+} chudnovskyPhase_e;
+
+// P, Q and T of the term range [a, b)
+typedef struct {
+	mpz_t p;
+	mpz_t q;
+	mpz_t t;
+} bsRange_t;
+
+typedef struct {
+	unsigned long a;
+	unsigned long b;
+	bsRange_t *range;
+} bsLeaf_t;
+
+typedef struct {
+	mpz_ptr result;
+	mpz_srcptr x;
+	mpz_srcptr y;
+} bsProduct_t;
+
+static uint32_t digits = CHUDNOVSKY_DEFAULT_DIGITS;
+static threadPool_t *pool;
+
+static chudnovskyPhase_e phase;
+static mpz_t c3Over24;
+static mpz_t q;
+static mpz_t t;
+static mpz_t scale;
+static mpz_t pi;
+static char *text;
+static uint32_t released;
+static float estimate;
+// Below pi by less than this, the decimals the estimate was read from end
+static float truncation;
+static char latest[ENGINE_LATEST_DIGITS];
+static int initialised;
+
+void chudnovskySetDigits(uint32_t count) {
+	if (count < 2) {
+		count = 2;
+	}
+	if (count > CHUDNOVSKY_MAX_DIGITS) {
+		count = CHUDNOVSKY_MAX_DIGITS;
+	}
+	digits = count;
+}
+
+static void bsInit(bsRange_t *range) {
+	mpz_init(range->p);
+	mpz_init(range->q);
+	mpz_init(range->t);
+}
+
+static void bsClear(bsRange_t *range) {
+	mpz_clear(range->p);
+	mpz_clear(range->q);
+	mpz_clear(range->t);
+}
+
+static void bsTerm(unsigned long k, bsRange_t *range) {
+	if (k == 0) {
+		mpz_set_ui(range->p, 1);
+		mpz_set_ui(range->q, 1);
+		mpz_set_ui(range->t, CHUDNOVSKY_A);
+		return;
+	}
+	
+	mpz_set_ui(range->p, 6 * k - 5);
+	mpz_mul_ui(range->p, range->p, 2 * k - 1);
+	mpz_mul_ui(range->p, range->p, 6 * k - 1);
+	
+	mpz_set_ui(range->q, k);
+	mpz_mul_ui(range->q, range->q, k);
+	mpz_mul_ui(range->q, range->q, k);
+	mpz_mul(range->q, range->q, c3Over24);
+	
+	mpz_mul_ui(range->t, range->p, k);
+	mpz_mul_ui(range->t, range->t, CHUDNOVSKY_B);
+	mpz_addmul_ui(range->t, range->p, CHUDNOVSKY_A);
+	if (k & 1) {
+		mpz_neg(range->t, range->t);
+	}
+}
+
+// [a, m) and [m, b) to [a, b): P = Pl Pr, Q = Ql Qr, T = Tl Qr + Pl Tr.
+// The result replaces left.
+static void bsMerge(bsRange_t *left, const bsRange_t *right) {
+	mpz_t product;
+	
+	mpz_init(product);
+	mpz_mul(product, left->p, right->t);
+	mpz_mul(left->t, left->t, right->q);
+	mpz_add(left->t, left->t, product);
+	mpz_mul(left->p, left->p, right->p);
+	mpz_mul(left->q, left->q, right->q);
+	mpz_clear(product);
+}
+
+// Plain recursive binary splitting of [a, b) into range
+static void bsSplit(unsigned long a, unsigned long b, bsRange_t *range) {
+	bsRange_t right;
+	unsigned long m;
+	
+	if (b - a == 1) {
+		bsTerm(a, range);
+		return;
+	}
+	
+	m = (a + b) / 2;
+	bsSplit(a, m, range);
+	bsInit(&right);
+	bsSplit(m, b, &right);
+	bsMerge(range, &right);
+	bsClear(&right);
+}
+
+static void bsLeafJob(void *argument) {
+	bsLeaf_t *leaf = (bsLeaf_t *) argument;
+	
+	bsSplit(leaf->a, leaf->b, leaf->range);
+}
+
+static void bsProductJob(void *argument) {
+	bsProduct_t *product = (bsProduct_t *) argument;
+	
+	mpz_mul(product->result, product->x, product->y);
+}
+
+// Splits the series into leaves that the pool computes independently,
+// then merges neighbours level by level. The products of every merge are
+// jobs of their own, so even the last merges, where only a pair or two
+// are left, keep several threads busy.
+static void chudnovskySeries(unsigned long terms) {
+	unsigned long count = (unsigned long) poolGetThreads() * LEAVES_PER_THREAD;
+	bsRange_t *ranges;
+	bsRange_t *merged;
+	mpz_t *cross;
+	bsLeaf_t *leaves;
+	bsProduct_t *products;
+	unsigned long pairs;
+	unsigned long jobs;
+	unsigned long k;
+	
+	if (count > terms) {
+		count = terms;
+	}
+	ranges = malloc(count * sizeof(bsRange_t));
+	merged = malloc(count * sizeof(bsRange_t));
+	cross = malloc(count * sizeof(mpz_t));
+	leaves = malloc(count * sizeof(bsLeaf_t));
+	products = malloc(count * 2 * sizeof(bsProduct_t));
+	
+	for (k = 0; k < count; k++) {
+		bsInit(&ranges[k]);
+		leaves[k].a = terms * k / count;
+		leaves[k].b = terms * (k + 1) / count;
+		leaves[k].range = &ranges[k];
+	}
+	poolRun(pool, bsLeafJob, leaves, sizeof(bsLeaf_t), count);
+	
+	while (count > 1) {
+		pairs = count / 2;
+		jobs = 0;
+		
+		for (k = 0; k < pairs; k++) {
+			bsRange_t *left = &ranges[2 * k];
+			bsRange_t *right = &ranges[2 * k + 1];
+			
+			bsInit(&merged[k]);
+			mpz_init(cross[k]);
+			products[jobs++] = (bsProduct_t) { merged[k].q, left->q, right->q };
+			products[jobs++] = (bsProduct_t) { merged[k].t, left->t, right->q };
+			products[jobs++] = (bsProduct_t) { cross[k], left->p, right->t };
+			// P of the whole series is never used
+			if (count > 2) {
+				products[jobs++] = (bsProduct_t) { merged[k].p, left->p, right->p };
+			}
+		}
+		poolRun(pool, bsProductJob, products, sizeof(bsProduct_t), jobs);
+		
+		for (k = 0; k < pairs; k++) {
+			mpz_add(merged[k].t, merged[k].t, cross[k]);
+			mpz_clear(cross[k]);
+			bsClear(&ranges[2 * k]);
+			bsClear(&ranges[2 * k + 1]);
+			ranges[k] = merged[k];
+		}
+		// An odd range left over moves up unchanged
+		if (count & 1) {
+			ranges[pairs] = ranges[count - 1];
+		}
+		count = (count + 1) / 2;
+	}
+	
+	mpz_swap(q, ranges[0].q);
+	mpz_swap(t, ranges[0].t);
+	bsClear(&ranges[0]);
+	
+	free(products);
+	free(leaves);
+	free(cross);
+	free(merged);
+	free(ranges);
+}
+
+static void chudnovskyInit(void) {
+	pool = poolShared();
+	
+	if (!initialised) {
+		mpz_init(c3Over24);
+		mpz_ui_pow_ui(c3Over24, CHUDNOVSKY_C, 3);
+		mpz_divexact_ui(c3Over24, c3Over24, 24);
+		mpz_init(q);
+		mpz_init(t);
+		mpz_init(scale);
+		mpz_init(pi);
+		initialised = 1;
+	}
+	free(text);
+	text = NULL;
+	
+	engineClearDigits(latest);
+	phase = Phase_Series;
+	released = 0;
+	estimate = 3.0;
+	truncation = 1.0;
+}
+
+// pi 10^n = 426880 Q 10^n / T * sqrt(10005) 10^n / 10^n in fixed point
+// with n = digits + GUARD_DIGITS
+static void chudnovskyDivide(void) {
+	mpz_ui_pow_ui(scale, 10, digits + GUARD_DIGITS);
+	mpz_mul_ui(q, q, CHUDNOVSKY_SCALE);
+	mpz_mul(q, q, scale);
+	mpz_tdiv_q(pi, q, t);
+	mpz_set_ui(q, 0);
+	mpz_set_ui(t, 0);
+}
+
+static void chudnovskySqrt(void) {
+	mpz_mul(q, scale, scale);
+	mpz_mul_ui(q, q, CHUDNOVSKY_ROOT);
+	mpz_sqrt(q, q);
+	mpz_mul(pi, pi, q);
+	mpz_tdiv_q(pi, pi, scale);
+	mpz_set_ui(q, 0);
+}
+
+// Decimal string of pi 10^n, cut to the requested digits. The estimate
+// is read from up to 12 decimals, more than a float holds, and is off by
+// its rounding plus the decimals cut.
+static void chudnovskyConvert(void) {
+	char leading[15];
+	uint32_t k;
+	
+	text = mpz_get_str(NULL, 10, pi);
+	text[digits] = '\0';
+	released = digits;
+	
+	for (k = released > ENGINE_LATEST_DIGITS ? released - ENGINE_LATEST_DIGITS : 0; k < released; k++) {
+		engineShiftDigit(latest, text[k]);
+	}
+	
+	leading[0] = text[0];
+	leading[1] = '.';
+	strncpy(&leading[2], &text[1], sizeof(leading) - 3);
+	leading[sizeof(leading) - 1] = '\0';
+	estimate = strtof(leading, NULL);
+	truncation = pow(10, -(int) (strlen(leading) - 2));
+}
+
+// A step is a whole phase: the series, the division, the square root or
+// the conversion to decimal
+static uint16_t chudnovskyStepBatch(uint16_t steps) {
+	uint16_t done;
+	
+	for (done = 0; done < steps && phase != Phase_Done; done++) {
+		switch (phase) {
+			case Phase_Series:
+				chudnovskySeries((unsigned long) (digits / DIGITS_PER_TERM) + 2);
+				break;
+			case Phase_Divide:
+				chudnovskyDivide();
+				break;
+			case Phase_Sqrt:
+				chudnovskySqrt();
+				break;
+			default:
+				chudnovskyConvert();
+				break;
+		}
+		phase++;
+	}
+	
+	return done;
+}
+
+static float chudnovskyEstimate(void) {
+	return estimate;
+}
+
+static float chudnovskyErrorBound(void) {
+	if (phase != Phase_Done) {
+		return 1.0;
+	}
+	// The cut counts twice, the second one covers the rounding of the sum
+	return engineHalfUlp(estimate) + 2 * truncation;
+}
+
+static uint16_t chudnovskyDigits(char *buffer) {
+	engineCopyDigits(buffer, latest);
+	
+	// The interface counts digits in 16 bits
+	return released > UINT16_MAX ? UINT16_MAX : released;
+}
+
+static uint32_t chudnovskyGetParameter(void) {
+	return digits;
+}
+
+// Ten times more digits, wrapping back to 1000
+static void chudnovskyStepParameter(void) {
+	if (digits >= CHUDNOVSKY_MAX_DIGITS) {
+		digits = 1000;
+	} else {
+		chudnovskySetDigits(digits * 10);
+	}
+}
+
+static const char *chudnovskyPhaseName(void) {
+	static const char *const names[] = { "series", "division", "sqrt", "conversion", "done" };
+	
+	return names[phase];
+}
+
+const piEngine_t chudnovskyEngine = {
+	.name = "Chudnovsky",
+	.termsPerStep = 1,
+	.batchLimit = 1,
+	.init = chudnovskyInit,
+	.stepBatch = chudnovskyStepBatch,
+	.estimate = chudnovskyEstimate,
+	.errorBound = chudnovskyErrorBound,
+	.digits = chudnovskyDigits,
+	.parameterName = "digits",
+	.getParameter = chudnovskyGetParameter,
+	.stepParameter = chudnovskyStepParameter,
+	.phaseName = chudnovskyPhaseName,
+};
@@ -0,0 +1,395 @@
+/*
+ * engine_parallel.c
+ *
+ * Created: 18.10.2026 16:21:30
+ */ 
+
+#include <stdlib.h>
+#include <math.h>
+#include "pi_engine.h"
+#include "engine_parallel.h"
+#include "thread_pool.h"
+
+// Leibniz pairs or Wallis factors of one step, each step is one pool job
+#define PARALLEL_CHUNK      4096
+// Doubles per vector, one AVX2 register or two SSE2 ones
+#define PARALLEL_LANES      4
+// Unit roundoff of double
+#define DOUBLE_ROUNDOFF     1.1102230246251565e-16
+// Sum of |pairs| of Leibniz, 1 + (1 - pi/4) and some margin
+#define PAIRED_MAGNITUDE    1.25
+
+// Monte Carlo: streams of PARALLEL_LANES generators each, one per thread
+#define MONTE_CARLO_MAX_STREAMS  64
+#define MONTE_CARLO_SEED         0x5eed5eed5eed5eedULL
+// Two sided 95% quantile of the normal distribution
+#define CONFIDENCE_Z             1.959964
+
+#if PARALLEL_CHUNK % PARALLEL_LANES != 0
+#error PARALLEL_CHUNK has to be a multiple of PARALLEL_LANES
+#endif
+
+// GCC vector extension, compiled to the widest SIMD the target flags allow
+typedef double vector_t __attribute__((vector_size(PARALLEL_LANES * sizeof(double))));
+typedef uint64_t ulVector_t __attribute__((vector_size(PARALLEL_LANES * sizeof(uint64_t))));
+
+typedef struct {
+	uint64_t first;                   // first pair or factor of the chunk
+	double result;                    // its partial sum or product
+} parallelChunk_t;
+
+static parallelChunk_t *chunks;
+static uint16_t chunkCapacity;
+static uint64_t done;                 // pairs or factors so far
+static double sum;
+static double compensation;
+static double product;
+
+// xoshiro256+ state of PARALLEL_LANES generators, word w of lane j in s[w][j]
+typedef struct {
+	ulVector_t s[4];
+	uint64_t chunks;                  // chunks to sample in this batch
+	uint64_t inside;                  // hits of this batch
+} monteCarloStream_t;
+
+static monteCarloStream_t streams[MONTE_CARLO_MAX_STREAMS];
+static unsigned streamCount;
+static uint64_t samples;
+static uint64_t inside;
+
+// Chunk descriptors for a batch, always starting at a multiple of
+// PARALLEL_CHUNK, so the chunks are the same whatever the batch size
+static parallelChunk_t *parallelChunks(uint16_t steps) {
+	uint16_t k;
+	
+	if (steps > chunkCapacity) {
+		free(chunks);
+		chunks = malloc(steps * sizeof(parallelChunk_t));
+		chunkCapacity = chunks != NULL ? steps : 0;
+	}
+	for (k = 0; k < steps && k < chunkCapacity; k++) {
+		chunks[k].first = done + (uint64_t) k * PARALLEL_CHUNK;
+	}
+	
+	return chunks;
+}
+
+// Lane j of a vector starts at the given value plus j times step
+static vector_t vectorRamp(double start, double step) {
+	vector_t ramp;
+	uint8_t j;
+	
+	for (j = 0; j < PARALLEL_LANES; j++) {
+		ramp[j] = start + j * step;
+	}
+	return ramp;
+}
+
+static vector_t vectorSplat(double value) {
+	return vectorRamp(value, 0);
+}
+
+//----------------------------------------------
+// Leibniz, pi/4 = 1 - 2/(3*5) - 2/(7*9) - ... with one division per pair
+//
+static void leibnizChunkJob(void *argument) {
+	parallelChunk_t *chunk = (parallelChunk_t *) argument;
+	vector_t d = vectorRamp(4 * (double) chunk->first + 3, 4);
+	const vector_t step = vectorSplat(4 * PARALLEL_LANES);
+	const vector_t two = vectorSplat(2);
+	vector_t partial = vectorSplat(0);
+	uint32_t k;
+	
+	// Lane j sums the pairs first + j, first + j + LANES, ...
+	for (k = 0; k < PARALLEL_CHUNK; k += PARALLEL_LANES) {
+		partial -= two / (d * (d + two));
+		d += step;
+	}
+	
+	// Fixed order, the lanes are added the same way on every run
+	chunk->result = ((partial[0] + partial[1]) + partial[2]) + partial[3];
+}
+
+static void parallelLeibnizInit(void) {
+	sum = 1.0;
+	compensation = 0.0;
+	done = 0;
+}
+
+static uint16_t parallelLeibnizStepBatch(uint16_t steps) {
+	parallelChunk_t *batch = parallelChunks(steps);
+	double y;
+	double t;
+	uint16_t k;
+	
+	if (batch == NULL) {
+		return 0;
+	}
+	poolRun(poolShared(), leibnizChunkJob, batch, sizeof(parallelChunk_t), steps);
+	
+	// Reduce in chunk order with Kahan summation, whichever thread
+	// computed which chunk
+	for (k = 0; k < steps; k++) {
+		y = batch[k].result + compensation;
+		t = sum + y;
+		compensation = y - (t - sum);
+		sum = t;
+	}
+	done += (uint64_t) steps * PARALLEL_CHUNK;
+	
+	return steps;
+}
+
+static float parallelLeibnizEstimate(void) {
+	return 4 * (sum + compensation);
+}
+
+// Tail 4/(4n+3), the rounding of the pairs, of the lane sums of a chunk
+// and of the Kahan reduction, and the conversion of the estimate to float
+static float parallelLeibnizErrorBound(void) {
+	double rounding = (PARALLEL_CHUNK / PARALLEL_LANES + 5) * DOUBLE_ROUNDOFF * PAIRED_MAGNITUDE;
+	
+	return 4 / (4 * (double) done + 3) + 4 * rounding + engineHalfUlp(parallelLeibnizEstimate());
+}
+
+//----------------------------------------------
+// Wallis, pi = 4 * (1 - 1/3^2) * (1 - 1/5^2) * ...
+//
+static void wallisChunkJob(void *argument) {
+	parallelChunk_t *chunk = (parallelChunk_t *) argument;
+	vector_t i = vectorRamp(2 * (double) chunk->first + 3, 2);
+	const vector_t step = vectorSplat(2 * PARALLEL_LANES);
+	const vector_t one = vectorSplat(1);
+	vector_t partial = one;
+	uint32_t k;
+	
+	for (k = 0; k < PARALLEL_CHUNK; k += PARALLEL_LANES) {
+		partial *= one - one / (i * i);
+		i += step;
+	}
+	
+	chunk->result = ((partial[0] * partial[1]) * partial[2]) * partial[3];
+}
+
+static void parallelWallisInit(void) {
+	product = 4.0;
+	done = 0;
+}
+
+static uint16_t parallelWallisStepBatch(uint16_t steps) {
+	parallelChunk_t *batch = parallelChunks(steps);
+	uint16_t k;
+	
+	if (batch == NULL) {
+		return 0;
+	}
+	poolRun(poolShared(), wallisChunkJob, batch, sizeof(parallelChunk_t), steps);
+	
+	for (k = 0; k < steps; k++) {
+		product *= batch[k].result;
+	}
+	done += (uint64_t) steps * PARALLEL_CHUNK;
+	
+	return steps;
+}
+
+static float parallelWallisEstimate(void) {
+	return product;
+}
+
+// Tail product/(4n+3) like the float engine, four roundings per factor
+// plus the reduction, and the conversion of the estimate to float
+static float parallelWallisErrorBound(void) {
+	double rounding = product * (4 * (double) done + PARALLEL_LANES + 1) * DOUBLE_ROUNDOFF;
+	
+	return product / (4 * (double) done + 3) + rounding + engineHalfUlp(parallelWallisEstimate());
+}
+
+//----------------------------------------------
+// Monte Carlo with xoshiro256+. Every generator of every stream starts
+// 2^128 outputs after the previous one, so no two ever overlap.
+//
+static uint64_t splitMix64(uint64_t *x) {
+	uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+	
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+static void xoshiroNext(uint64_t *s) {
+	uint64_t t = s[1] << 17;
+	
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = (s[3] << 45) | (s[3] >> 19);
+}
+
+// Advances the generator by 2^128 steps
+static void xoshiroJump(uint64_t *s) {
+	static const uint64_t jump[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+	uint64_t result[4] = { 0, 0, 0, 0 };
+	uint8_t w;
+	uint8_t b;
+	uint8_t k;
+	
+	for (w = 0; w < 4; w++) {
+		for (b = 0; b < 64; b++) {
+			if (jump[w] & (1ULL << b)) {
+				for (k = 0; k < 4; k++) {
+					result[k] ^= s[k];
+				}
+			}
+			xoshiroNext(s);
+		}
+	}
+	for (k = 0; k < 4; k++) {
+		s[k] = result[k];
+	}
+}
+
+// Samples the stream's chunks, PARALLEL_LANES points at a time. Like on
+// the AVR the point is the middle of its grid cell, here with 31 bit
+// coordinates: (2x+1)^2 + (2y+1)^2 < 2^64, detected by the wrap around
+// of the 64-bit sum.
+static void monteCarloStreamJob(void *argument) {
+	monteCarloStream_t *stream = (monteCarloStream_t *) argument;
+	ulVector_t s0 = stream->s[0];
+	ulVector_t s1 = stream->s[1];
+	ulVector_t s2 = stream->s[2];
+	ulVector_t s3 = stream->s[3];
+	ulVector_t hits = s0 - s0;
+	ulVector_t random;
+	ulVector_t t;
+	ulVector_t x;
+	ulVector_t y;
+	ulVector_t square;
+	uint64_t points = stream->chunks * PARALLEL_CHUNK;
+	uint64_t k;
+	uint8_t j;
+	
+	for (k = 0; k < points; k += PARALLEL_LANES) {
+		random = s0 + s3;
+		t = s1 << 17;
+		s2 ^= s0;
+		s3 ^= s1;
+		s1 ^= s2;
+		s0 ^= s3;
+		s2 ^= t;
+		s3 = (s3 << 45) | (s3 >> 19);
+		
+		x = (random >> 32) | 1;
+		y = (random & 0xffffffffULL) | 1;
+		square = x * x;
+		// Comparisons give -1 in the lanes where they hold
+		hits -= (ulVector_t) ((square + y * y) >= square);
+	}
+	
+	stream->s[0] = s0;
+	stream->s[1] = s1;
+	stream->s[2] = s2;
+	stream->s[3] = s3;
+	stream->inside = 0;
+	for (j = 0; j < PARALLEL_LANES; j++) {
+		stream->inside += hits[j];
+	}
+}
+
+// One stream per thread at the time of the init
+static void parallelMonteCarloInit(void) {
+	uint64_t seed = MONTE_CARLO_SEED;
+	uint64_t s[4];
+	unsigned n;
+	uint8_t j;
+	uint8_t w;
+	
+	streamCount = poolGetThreads();
+	if (streamCount > MONTE_CARLO_MAX_STREAMS) {
+		streamCount = MONTE_CARLO_MAX_STREAMS;
+	}
+	for (w = 0; w < 4; w++) {
+		s[w] = splitMix64(&seed);
+	}
+	for (n = 0; n < streamCount; n++) {
+		for (j = 0; j < PARALLEL_LANES; j++) {
+			for (w = 0; w < 4; w++) {
+				streams[n].s[w][j] = s[w];
+			}
+			xoshiroJump(s);
+		}
+	}
+	samples = 0;
+	inside = 0;
+}
+
+// The chunks of a batch are dealt out to the streams, each stream is one
+// pool job. The hits are added up in stream order.
+static uint16_t parallelMonteCarloStepBatch(uint16_t steps) {
+	unsigned n;
+	
+	for (n = 0; n < streamCount; n++) {
+		streams[n].chunks = steps / streamCount + (n < steps % streamCount);
+	}
+	poolRun(poolShared(), monteCarloStreamJob, streams, sizeof(monteCarloStream_t), streamCount);
+	
+	for (n = 0; n < streamCount; n++) {
+		inside += streams[n].inside;
+	}
+	samples += (uint64_t) steps * PARALLEL_CHUNK;
+	
+	return steps;
+}
+
+static float parallelMonteCarloEstimate(void) {
+	if (samples == 0) {
+		return 0;
+	}
+	return 4 * (double) inside / samples;
+}
+
+static float parallelMonteCarloErrorBound(void) {
+	return 4.0;
+}
+
+static float parallelMonteCarloConfidence(void) {
+	double p;
+	
+	if (samples == 0) {
+		return 4.0;
+	}
+	p = (double) inside / samples;
+	return CONFIDENCE_Z * 4 * sqrt(p * (1 - p) / samples);
+}
+
+const piEngine_t parallelLeibnizEngine = {
+	.name = "Leibniz MT",
+	.termsPerStep = 2 * PARALLEL_CHUNK,
+	.maxDigits = 7,
+	.init = parallelLeibnizInit,
+	.stepBatch = parallelLeibnizStepBatch,
+	.estimate = parallelLeibnizEstimate,
+	.errorBound = parallelLeibnizErrorBound,
+};
+
+const piEngine_t parallelWallisEngine = {
+	.name = "Wallis MT",
+	.termsPerStep = PARALLEL_CHUNK,
+	.maxDigits = 7,
+	.init = parallelWallisInit,
+	.stepBatch = parallelWallisStepBatch,
+	.estimate = parallelWallisEstimate,
+	.errorBound = parallelWallisErrorBound,
+};
+
+const piEngine_t parallelMonteCarloEngine = {
+	.name = "MC Parallel",
+	.termsPerStep = PARALLEL_CHUNK,
+	.init = parallelMonteCarloInit,
+	.stepBatch = parallelMonteCarloStepBatch,
+	.estimate = parallelMonteCarloEstimate,
+	.errorBound = parallelMonteCarloErrorBound,
+	.confidence = parallelMonteCarloConfidence,
+};
@@ -0,0 +1,21 @@
+/*
+ * engine_chudnovsky.h
+ *
+ * Created: 18.10.2026 14:32:47
+ */ 
+
+
+#ifndef ENGINE_CHUDNOVSKY_H_
+#define ENGINE_CHUDNOVSKY_H_
+
+#include <stdint.h>
+#include "pi_engine.h"
+
+// Host only, needs GMP and POSIX threads
+extern const piEngine_t chudnovskyEngine;
+
+// Decimal digits to produce, the leading 3 included. Takes effect with
+// the next init, the binary splitting runs on poolShared().
+void chudnovskySetDigits(uint32_t digits);
+
+#endif /* ENGINE_CHUDNOVSKY_H_ */
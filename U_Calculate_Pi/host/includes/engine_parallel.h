@@ -0,0 +1,22 @@
+/*
+ * engine_parallel.h
+ *
+ * Created: 18.10.2026 16:20:51
+ */ 
+
+
+#ifndef ENGINE_PARALLEL_H_
+#define ENGINE_PARALLEL_H_
+
+#include "pi_engine.h"
+
+// Host only, the Leibniz and Wallis kernels in double precision spread
+// over the threads of poolShared(). Results do not depend on the thread
+// count or the batch size.
+extern const piEngine_t parallelLeibnizEngine;
+extern const piEngine_t parallelWallisEngine;
+// Monte Carlo with one random stream per thread, reproducible for the
+// same thread count and batch size
+extern const piEngine_t parallelMonteCarloEngine;
+
+#endif /* ENGINE_PARALLEL_H_ */
@@ -0,0 +1,36 @@
+/*
+ * thread_pool.h
+ *
+ * Created: 18.10.2026 14:10:22
+ */ 
+
+
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <stddef.h>
+
+// Fixed set of worker threads that run batches of independent jobs. The
+// calling thread works on the batch as well, so a pool of n threads
+// keeps n + 1 cores busy.
+typedef struct threadPool threadPool_t;
+
+typedef void (*poolJob_t)(void *argument);
+
+// Returns NULL if the threads could not be started
+threadPool_t *poolCreate(unsigned threads);
+void poolDestroy(threadPool_t *pool);
+
+// Calls job once for each of the count arguments, which lie size bytes
+// apart from arguments on, and returns once all calls are done
+void poolRun(threadPool_t *pool, poolJob_t job, void *arguments, size_t size, size_t count);
+
+// Threads the engines of the host build use together, the calling thread
+// included. 0, the default, takes one per online core.
+void poolSetThreads(unsigned threads);
+unsigned poolGetThreads(void);
+// Pool with poolGetThreads() - 1 workers shared by all engines, created
+// on first use and again after the thread count changed
+threadPool_t *poolShared(void);
+
+#endif /* THREAD_POOL_H_ */
@@ -0,0 +1,304 @@
+/*
+ * main.c
+ *
+ * Created: 18.10.2026 15:02:13
+ *
+ * Host driver for the pi engines. Runs the same engine descriptors as the
+ * XMEGA build plus the host only ones, without RTOS and display.
+ */ 
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <getopt.h>
+#include <time.h>
+#include <math.h>
+#include "pi_engine.h"
+#include "pi_target.h"
+#include "engine_chudnovsky.h"
+#include "engine_parallel.h"
+#include "thread_pool.h"
+
+#define DEFAULT_BATCH    1024
+#define DEFAULT_SECONDS  10.0
+// Time the scaling benchmark runs with one thread, the other thread
+// counts do the same amount of work
+#define BENCHMARK_SECONDS  2.0
+// pi in double precision, unsuffixed constants are float in this build
+#define PI_DOUBLE  ((double) 3.14159265358979323846L)
+
+// Engines only the host build has, after the shared piEngines[]
+static const piEngine_t * const hostEngines[] = {
+	&chudnovskyEngine,
+	&parallelLeibnizEngine,
+	&parallelWallisEngine,
+	&parallelMonteCarloEngine,
+};
+
+#define HOST_ENGINE_COUNT  (sizeof(hostEngines) / sizeof(hostEngines[0]))
+
+static const piEngine_t *engineAt(unsigned index) {
+	if (index < piEngineCount) {
+		return piEngines[index];
+	}
+	return hostEngines[index - piEngineCount];
+}
+
+static unsigned engineCount(void) {
+	return piEngineCount + HOST_ENGINE_COUNT;
+}
+
+// By index or by name, ignoring case
+static const piEngine_t *engineFind(const char *name) {
+	char *end;
+	unsigned long index = strtoul(name, &end, 10);
+	unsigned k;
+	
+	if (*name != '\0' && *end == '\0') {
+		return index < engineCount() ? engineAt(index) : NULL;
+	}
+	for (k = 0; k < engineCount(); k++) {
+		if (strcasecmp(engineAt(k)->name, name) == 0) {
+			return engineAt(k);
+		}
+	}
+	return NULL;
+}
+
+// Largest target the engine can reach, the Chudnovsky engine gets as far
+// as its digits setting
+static unsigned long maxTarget(const piEngine_t *engine) {
+	unsigned long digits = engine->maxDigits;
+	
+	if (engine == &chudnovskyEngine) {
+		digits = engine->getParameter();
+	}
+	return digits < UINT16_MAX ? digits : UINT16_MAX;
+}
+
+static double seconds(void) {
+	struct timespec now;
+	
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static void usage(const char *program) {
+	fprintf(stderr,
+		"usage: %s [-l] [-S] [-c] [-e engine] [-d digits] [-t threads] [-b batch] [-T target] [-s seconds]\n"
+		"  -l          list the engines\n"
+		"  -S          terms/s of the engine for 1 up to the -t threads\n"
+		"  -c          check |estimate - pi| <= error bound after every batch\n"
+		"  -e engine   engine name or index (default 0)\n"
+		"  -d digits   digits for the Chudnovsky engine\n"
+		"  -t threads  threads of the host engines (default all cores)\n"
+		"  -b batch    steps per batch (default %u)\n"
+		"  -T target   stop once this many digits are certified\n"
+		"  -s seconds  stop after this time, 0 for none (default %.0f for\n"
+		"              engines that never finish, else none)\n",
+		program, DEFAULT_BATCH, DEFAULT_SECONDS);
+}
+
+// Runs the engine with 1, 2, ... threads up to poolGetThreads(). The one
+// thread run takes the given time, the others compute the same batches,
+// so their results have to match it exactly.
+static void benchmarkScaling(const piEngine_t *engine, unsigned long batch, double limit) {
+	unsigned threads = poolGetThreads();
+	unsigned long batches = 0;
+	unsigned long k;
+	unsigned n;
+	double start;
+	double elapsed;
+	double rate;
+	double single = 0;
+	float estimate = 0;
+	
+	printf("threads        terms/s  speedup  efficiency\n");
+	for (n = 1; n <= threads; n++) {
+		poolSetThreads(n);
+		engine->init();
+		start = seconds();
+		if (n == 1) {
+			do {
+				engine->stepBatch(batch);
+				batches++;
+				elapsed = seconds() - start;
+			} while (elapsed < limit);
+		} else {
+			for (k = 0; k < batches; k++) {
+				engine->stepBatch(batch);
+			}
+			elapsed = seconds() - start;
+		}
+		
+		rate = (double) batches * batch * engine->termsPerStep / elapsed;
+		if (n == 1) {
+			single = rate;
+			estimate = engine->estimate();
+		}
+		// Random engines draw one stream per thread, their results differ
+		printf("%7u %14.0f %7.2fx %10.0f%%%s\n", n, rate, rate / single, 100 * rate / single / n,
+			engine->confidence != NULL || engine->estimate() == estimate ? "" : "  result differs");
+	}
+	poolSetThreads(threads);
+}
+
+// Time of one phase of an engine, the rate is the digits the whole run
+// produces over it. Engines without a digits setting get the time only.
+static void printPhase(const char *phase, double elapsed, unsigned long digits) {
+	if (digits == 0) {
+		printf("%-12s %10.3f s\n", phase, elapsed);
+	} else {
+		printf("%-12s %10.3f s %14.0f digits/s\n", phase, elapsed, elapsed > 0 ? digits / elapsed : 0.0);
+	}
+}
+
+int main(int argc, char **argv) {
+	const piEngine_t *engine = piEngines[0];
+	const char *phase = NULL;
+	const char *next;
+	char *end;
+	char latest[ENGINE_LATEST_DIGITS];
+	unsigned long batch = DEFAULT_BATCH;
+	unsigned long target = 0;
+	unsigned long digits = 0;
+	double limit = -1;
+	double start;
+	double phaseStart;
+	double phaseTime = 0;
+	double elapsed;
+	uint64_t iterations = 0;
+	uint16_t steps;
+	uint16_t certified = 0;
+	int option;
+	int scaling = 0;
+	int check = 0;
+	unsigned long broken = 0;
+	double error;
+	unsigned k;
+	
+	while ((option = getopt(argc, argv, "lSce:d:t:b:T:s:")) != -1) {
+		switch (option) {
+			case 'l':
+				for (k = 0; k < engineCount(); k++) {
+					printf("%2u %s\n", k, engineAt(k)->name);
+				}
+				return 0;
+			case 'S':
+				scaling = 1;
+				break;
+			case 'c':
+				check = 1;
+				break;
+			case 'e':
+				engine = engineFind(optarg);
+				if (engine == NULL) {
+					fprintf(stderr, "unknown engine %s\n", optarg);
+					return 1;
+				}
+				break;
+			case 'd':
+				digits = strtoul(optarg, NULL, 10);
+				chudnovskySetDigits(digits);
+				break;
+			case 't':
+				poolSetThreads(strtoul(optarg, NULL, 10));
+				break;
+			case 'b':
+				batch = strtoul(optarg, NULL, 10);
+				break;
+			case 'T':
+				target = strtoul(optarg, &end, 10);
+				if (*optarg == '\0' || *end != '\0' || target == 0) {
+					usage(argv[0]);
+					return 1;
+				}
+				break;
+			case 's':
+				limit = strtod(optarg, NULL);
+				break;
+			default:
+				usage(argv[0]);
+				return 1;
+		}
+	}
+	// Certified digits are counted in 16 bits, a target beyond the engine
+	// would never end the run
+	if (target > maxTarget(engine)) {
+		fprintf(stderr, "target %lu out of range, %s reaches up to %lu digits\n", target, engine->name, maxTarget(engine));
+		usage(argv[0]);
+		return 1;
+	}
+	if (engine->batchLimit != 0 && batch > engine->batchLimit) {
+		batch = engine->batchLimit;
+	}
+	if (batch == 0 || batch > UINT16_MAX) {
+		batch = DEFAULT_BATCH;
+	}
+	if (scaling) {
+		printf("%s, batch %lu\n", engine->name, batch);
+		benchmarkScaling(engine, batch, limit > 0 ? limit : BENCHMARK_SECONDS);
+		return 0;
+	}
+	// Engines with phases end by themselves, series run forever
+	if (limit < 0) {
+		limit = engine->phaseName != NULL ? 0 : DEFAULT_SECONDS;
+	}
+	if (engine->getParameter != NULL) {
+		digits = engine->getParameter();
+		printf("%s, %s=%lu\n", engine->name, engine->parameterName, digits);
+	} else {
+		printf("%s\n", engine->name);
+	}
+	
+	engine->init();
+	start = seconds();
+	for (;;) {
+		// Engines with phases are timed phase by phase, a phase may take
+		// many batches
+		next = engine->phaseName != NULL ? engine->phaseName() : NULL;
+		if (phase != NULL && strcmp(next, phase) != 0) {
+			printPhase(phase, phaseTime, digits);
+			phaseTime = 0;
+		}
+		phase = next;
+		phaseStart = seconds();
+		steps = engine->stepBatch(batch);
+		phaseTime += seconds() - phaseStart;
+		iterations += (uint64_t) steps * engine->termsPerStep;
+		
+		certified = engineCertifiedDigits(engine, latest);
+		// The error bound of random engines guarantees nothing
+		error = fabs(engine->estimate() - PI_DOUBLE);
+		if (check && engine->confidence == NULL && error > engine->errorBound()) {
+			if (broken++ < 10) {
+				printf("bound broken after %llu terms: %.6e > %.6e\n", (unsigned long long) iterations, error, engine->errorBound());
+			}
+		}
+		if (steps == 0 || (target > 0 && targetReached(target, certified, latest)) || (limit > 0 && seconds() - start >= limit)) {
+			break;
+		}
+	}
+	// The phase the run stopped in, unless the engine had finished
+	if (phase != NULL && steps > 0) {
+		printPhase(phase, phaseTime, digits);
+	}
+	elapsed = seconds() - start;
+	
+	printf("time         %10.3f s\n", elapsed);
+	printf("iterations   %10llu\n", (unsigned long long) iterations);
+	printf("rate         %10.0f terms/s\n", elapsed > 0 ? iterations / elapsed : 0.0);
+	printf("estimate     %.9f +- %.1e\n", engine->estimate(), engine->errorBound());
+	if (engine->confidence != NULL) {
+		printf("confidence   %.9f +- %.1e (95%%)\n", engine->estimate(), engine->confidence());
+	}
+	// The interface counts digits in 16 bits
+	printf("certified    %10u%s digits\n", certified, certified == UINT16_MAX ? "+" : "");
+	printf("latest       %.*s\n", ENGINE_LATEST_DIGITS, latest);
+	if (check) {
+		printf("bound broken %10lu times\n", broken);
+	}
+	
+	return broken > 0;
+}
@@ -0,0 +1,163 @@
+/*
+ * thread_pool.c
+ *
+ * Created: 18.10.2026 14:11:05
+ */ 
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "thread_pool.h"
+
+struct threadPool {
+	pthread_mutex_t lock;
+	pthread_cond_t work;              // a batch was posted or the pool stops
+	pthread_cond_t done;              // the last job of the batch finished
+	pthread_t *threads;
+	unsigned threadCount;
+	bool stopping;
+	
+	// Current batch, next is the index of the next job nobody took yet
+	poolJob_t job;
+	char *arguments;
+	size_t size;
+	size_t count;
+	size_t next;
+	size_t pending;
+	unsigned long batch;              // increases with every batch
+};
+
+static unsigned sharedThreads;
+static threadPool_t *sharedPool;
+static unsigned sharedPoolThreads;
+
+// Takes and runs jobs of the current batch until none is left, the lock
+// is held on entry and on return
+static void poolWork(threadPool_t *pool) {
+	size_t index;
+	
+	while (pool->next < pool->count) {
+		index = pool->next++;
+		pthread_mutex_unlock(&pool->lock);
+		pool->job(pool->arguments + index * pool->size);
+		pthread_mutex_lock(&pool->lock);
+		
+		if (--pool->pending == 0) {
+			pthread_cond_broadcast(&pool->done);
+		}
+	}
+}
+
+static void *poolThread(void *argument) {
+	threadPool_t *pool = (threadPool_t *) argument;
+	unsigned long seen = 0;
+	
+	pthread_mutex_lock(&pool->lock);
+	for (;;) {
+		while (!pool->stopping && pool->batch == seen) {
+			pthread_cond_wait(&pool->work, &pool->lock);
+		}
+		if (pool->stopping) {
+			break;
+		}
+		seen = pool->batch;
+		poolWork(pool);
+	}
+	pthread_mutex_unlock(&pool->lock);
+	
+	return NULL;
+}
+
+threadPool_t *poolCreate(unsigned threads) {
+	threadPool_t *pool = calloc(1, sizeof(threadPool_t));
+	
+	if (pool == NULL) {
+		return NULL;
+	}
+	pool->threads = calloc(threads > 0 ? threads : 1, sizeof(pthread_t));
+	if (pool->threads == NULL) {
+		free(pool);
+		return NULL;
+	}
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->work, NULL);
+	pthread_cond_init(&pool->done, NULL);
+	
+	for (pool->threadCount = 0; pool->threadCount < threads; pool->threadCount++) {
+		if (pthread_create(&pool->threads[pool->threadCount], NULL, poolThread, pool) != 0) {
+			poolDestroy(pool);
+			return NULL;
+		}
+	}
+	
+	return pool;
+}
+
+void poolDestroy(threadPool_t *pool) {
+	unsigned k;
+	
+	pthread_mutex_lock(&pool->lock);
+	pool->stopping = true;
+	pthread_cond_broadcast(&pool->work);
+	pthread_mutex_unlock(&pool->lock);
+	
+	for (k = 0; k < pool->threadCount; k++) {
+		pthread_join(pool->threads[k], NULL);
+	}
+	pthread_cond_destroy(&pool->done);
+	pthread_cond_destroy(&pool->work);
+	pthread_mutex_destroy(&pool->lock);
+	free(pool->threads);
+	free(pool);
+}
+
+void poolRun(threadPool_t *pool, poolJob_t job, void *arguments, size_t size, size_t count) {
+	if (count == 0) {
+		return;
+	}
+	
+	pthread_mutex_lock(&pool->lock);
+	pool->job = job;
+	pool->arguments = (char *) arguments;
+	pool->size = size;
+	pool->count = count;
+	pool->next = 0;
+	pool->pending = count;
+	pool->batch++;
+	pthread_cond_broadcast(&pool->work);
+	
+	poolWork(pool);
+	while (pool->pending > 0) {
+		pthread_cond_wait(&pool->done, &pool->lock);
+	}
+	pthread_mutex_unlock(&pool->lock);
+}
+
+void poolSetThreads(unsigned threads) {
+	sharedThreads = threads;
+}
+
+unsigned poolGetThreads(void) {
+	long cores;
+	
+	if (sharedThreads > 0) {
+		return sharedThreads;
+	}
+	cores = sysconf(_SC_NPROCESSORS_ONLN);
+	return cores > 0 ? cores : 1;
+}
+
+threadPool_t *poolShared(void) {
+	unsigned threads = poolGetThreads();
+	
+	if (sharedPool == NULL || sharedPoolThreads != threads) {
+		if (sharedPool != NULL) {
+			poolDestroy(sharedPool);
+		}
+		sharedPool = poolCreate(threads - 1);
+		sharedPoolThreads = threads;
+	}
+	
+	return sharedPool;
+}
@@ -77,12 +77,32 @@
 //#define configTICK_RATE_HZ			( ( TickType_t ) 1000 )
 #define configMAX_PRIORITIES			( 4 )
 #define configMINIMAL_STACK_SIZE		( ( unsigned short ) 200 )
-#define configTOTAL_HEAP_SIZE			( (size_t ) ( 3000 ) )
+/* heap_1 only takes, nothing is freed. Stacks of the tasks (main.c, the
+display and button drivers, idle and timer: 2930 bytes), ten TCBs of 50
+bytes, the display queue (8 x 22 bytes), the timer queue, two mutexes
+and an event group come to about 3820 bytes, main.c checks the sum at
+compile time. Together with the engine workspace (2560) this leaves
+about 1700 bytes of the 8 KB SRAM for the other .data, .bss and the
+startup stack. View_Memory and View_Stacks show the measured slack of
+the SRAM, the heap and every task stack. */
+#define configTOTAL_HEAP_SIZE			( (size_t ) ( 3900 ) )
 #define configMAX_TASK_NAME_LEN			( 8 )
 #define configUSE_TRACE_FACILITY		1
 #define configUSE_16_BIT_TICKS			0
 #define configIDLE_SHOULD_YIELD			1
 #define configCHECK_FOR_STACK_OVERFLOW	2
+/* A heap too small for the tasks traps at boot instead of leaving NULL
+handles behind */
+#define configUSE_MALLOC_FAILED_HOOK	1
+
+/* Run time stats for the race scoreboard, counted in TCC1 steps of 2us.
+TCC1 is set up by vInitTimer() already. */
+#define configGENERATE_RUN_TIME_STATS	1
+#ifndef __ASSEMBLER__
+extern uint32_t ulRunTimeCounter(void);
+#endif
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()	ulRunTimeCounter()
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES 		1
@@ -101,6 +121,8 @@ to exclude the API function. */
 
 #define INCLUDE_uxTaskGetStackHighWaterMark	1 // used to check if stack is going low
 #define	INCLUDE_xTaskGetCurrentTaskHandle	1
+#define INCLUDE_xTaskGetHandle			1 // View_Stacks finds the driver tasks by name
+#define INCLUDE_xTaskGetIdleTaskHandle	1
 
 #define configUSE_TIMERS				1
 #define INCLUDE_xTimerPendFunctionCall	1
@@ -0,0 +1,43 @@
+/*
+ * ff_math.h
+ *
+ * Created: 17.10.2026 16:40:12
+ */ 
+
+
+#ifndef FF_MATH_H_
+#define FF_MATH_H_
+
+#include <stdint.h>
+
+// Float-float number, the unevaluated sum hi + lo with |lo| <= ulp(hi) / 2.
+// Two 24 bit mantissas give about 48 bits or 14 decimal digits, built only
+// from float additions and multiplications of the soft-float library.
+typedef struct {
+	float hi;
+	float lo;
+} ffFloat_t;
+
+// Decimal digits a float-float holds reliably
+#define FF_DIGITS  14
+
+ffFloat_t ffFromFloat(float a);
+// Exact for every value below 2^31
+ffFloat_t ffFromUint32(uint32_t a);
+
+// Error free transformations, hi is the rounded result and lo its exact error
+ffFloat_t ffTwoSum(float a, float b);
+ffFloat_t ffTwoProd(float a, float b);
+
+ffFloat_t ffAdd(ffFloat_t a, ffFloat_t b);
+ffFloat_t ffSub(ffFloat_t a, ffFloat_t b);
+ffFloat_t ffMul(ffFloat_t a, ffFloat_t b);
+ffFloat_t ffMulFloat(ffFloat_t a, float b);
+ffFloat_t ffDiv(ffFloat_t a, ffFloat_t b);
+ffFloat_t ffReciprocal(ffFloat_t a);
+
+// Writes the leading count decimal digits of a (0 <= a < 10) without a
+// decimal point or terminating zero
+void ffToDigits(ffFloat_t a, char *digits, uint8_t count);
+
+#endif /* FF_MATH_H_ */
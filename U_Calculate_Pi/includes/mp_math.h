@@ -0,0 +1,58 @@
+/*
+ * mp_math.h
+ *
+ * Created: 17.10.2026 15:02:26
+ */ 
+
+
+#ifndef MP_MATH_H_
+#define MP_MATH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Multi-precision fixed point numbers stored as arrays of 16-bit limbs,
+// most significant first. x[0] is the integer part, x[1] .. x[n-1] the
+// fraction in base 2^16. All functions work in place on n limbs.
+typedef uint16_t mpLimb_t;
+
+// Decimal digits held by one limb, times 1000 (16 * log10(2))
+#define MP_DIGITS_PER_LIMB_X1000  4816
+// Limbs needed for a number with the given count of decimal digits after
+// the point, plus the integer limb and two guard limbs for rounding errors
+#define MP_LIMBS_FOR_DIGITS(d)    ((d) * 1000UL / MP_DIGITS_PER_LIMB_X1000 + 4)
+
+void mpSetInt(mpLimb_t *x, uint16_t n, uint16_t value);
+void mpCopy(mpLimb_t *x, const mpLimb_t *y, uint16_t n);
+bool mpIsZero(const mpLimb_t *x, uint16_t n);
+
+// x += y and x -= y, return the carry / borrow out of the integer limb
+uint16_t mpAdd(mpLimb_t *x, const mpLimb_t *y, uint16_t n);
+uint16_t mpSub(mpLimb_t *x, const mpLimb_t *y, uint16_t n);
+
+// x *= factor, returns the overflow out of the integer limb
+uint16_t mpMulSmall(mpLimb_t *x, uint16_t n, uint16_t factor);
+// x /= divisor and x = y / divisor, both return the remainder
+uint16_t mpDivSmall(mpLimb_t *x, uint16_t n, uint16_t divisor);
+uint16_t mpDivSmallTo(mpLimb_t *x, const mpLimb_t *y, uint16_t n, uint16_t divisor);
+
+// Leading part of x as a float and a float rounded into x
+float mpToFloat(const mpLimb_t *x, uint16_t n);
+void mpSetFloat(mpLimb_t *x, uint16_t n, float value);
+
+// z = x * y, truncated to n limbs. z must not overlap x or y.
+void mpMul(mpLimb_t *z, const mpLimb_t *x, const mpLimb_t *y, uint16_t n);
+
+// Integer square root floor(sqrt(x)), one bit of the root per iteration
+// with only shifts, compares and subtractions
+uint32_t ulSqrt64(uint64_t x);
+
+// Newton iterations starting from a float seed (an integer root for the
+// square roots), with the precision doubled every iteration. scratch has
+// to provide the given number of n limb blocks.
+void mpReciprocal(mpLimb_t *r, const mpLimb_t *x, uint16_t n, mpLimb_t *scratch); // 2 blocks
+void mpInvSqrt(mpLimb_t *y, const mpLimb_t *x, uint16_t n, mpLimb_t *scratch);    // 2 blocks
+void mpSqrt(mpLimb_t *z, const mpLimb_t *x, uint16_t n, mpLimb_t *scratch);       // 3 blocks
+void mpDiv(mpLimb_t *z, const mpLimb_t *x, const mpLimb_t *y, uint16_t n, mpLimb_t *scratch); // 3 blocks
+
+#endif /* MP_MATH_H_ */
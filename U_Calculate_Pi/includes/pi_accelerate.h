@@ -0,0 +1,29 @@
+/*
+ * pi_accelerate.h
+ *
+ * Created: 17.10.2026 13:20:08
+ */ 
+
+
+#ifndef PI_ACCELERATE_H_
+#define PI_ACCELERATE_H_
+
+#include <stdint.h>
+
+// Consecutive partial sums kept for the acceleration, must be odd.
+// Five sums allow two rounds of Aitken's delta-squared process.
+#define ACCEL_DEPTH  5
+
+// Shanks transform (iterated Aitken) of the most recent partial sums of
+// an alternating series. The engine feeds every partial sum it wants
+// accelerated, sums have to be consecutive terms of the series.
+typedef struct {
+	float sums[ACCEL_DEPTH];   // oldest first
+	uint8_t count;
+} piAccelerator_t;
+
+void accelReset(piAccelerator_t *accel);
+void accelFeed(piAccelerator_t *accel, float sum);
+float accelEstimate(const piAccelerator_t *accel);
+
+#endif /* PI_ACCELERATE_H_ */
@@ -0,0 +1,58 @@
+/*
+ * pi_autotune.h
+ *
+ * Created: 18.10.2026 19:12:44
+ */ 
+
+
+#ifndef PI_AUTOTUNE_H_
+#define PI_AUTOTUNE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pi_engine.h"
+#include "pi_target.h"
+
+// EEPROM after the checkpoint ring holding the calibration table
+#define AUTOTUNE_EEPROM_SIZE   640
+// Engines the table has room for, piEngines[] beyond them are never picked
+#define AUTOTUNE_ENGINES       18
+// Terms or milliseconds to a target an engine is not expected to reach
+#define AUTOTUNE_NEVER         UINT32_MAX
+
+// What a calibration run of one engine saw. The run starts with the
+// engine's init and feeds every batch to autotuneRunFeed().
+typedef struct {
+	uint32_t terms[TARGET_COUNT];      // terms at which each target was reached
+	uint32_t firstTerms;               // first batch with verified digits
+	uint16_t firstDigits;
+	uint32_t peakTerms;                // first batch with the most verified digits
+	uint16_t peakDigits;
+} autotuneRun_t;
+
+// Checks the calibration table, false if there is none or it was
+// measured under another clock configuration than vInitClock() set up
+bool autotuneInit(void);
+// Engines in the table, the first ones of piEngines[]
+uint8_t autotuneEngineCount(void);
+
+void autotuneRunReset(autotuneRun_t *run);
+void autotuneRunFeed(autotuneRun_t *run, uint32_t terms, uint16_t certified, const char *latest);
+// Writes the entry of piEngines[engineIndex]: the time per term, from
+// the milliseconds the run took on the timer that also times the runs,
+// and the terms to every target, measured or extrapolated from the run
+// according to the convergence of the engine. finished is set if the
+// engine ended the run by itself.
+void autotuneRunStore(uint8_t engineIndex, const autotuneRun_t *run, uint32_t terms, float milliseconds, bool finished);
+// Marks the table valid for the current clock once every engine is stored
+void autotuneCommit(void);
+
+// Predicted time in ms for piEngines[engineIndex] to reach
+// targetDigits[targetIndex], AUTOTUNE_NEVER if it will not
+uint32_t autotunePredict(uint8_t engineIndex, uint8_t targetIndex);
+// Fastest engine for targetDigits[*targetIndex]. With a budget in ms (0
+// for none) that no engine meets, the target is lowered to the largest
+// one some engine still reaches in time. False if there is none at all.
+bool autotunePick(uint8_t *targetIndex, uint32_t budget, uint8_t *engineIndex, uint32_t *predicted);
+
+#endif /* PI_AUTOTUNE_H_ */
@@ -0,0 +1,43 @@
+/*
+ * pi_checkpoint.h
+ *
+ * Created: 18.10.2026 11:02:37
+ */ 
+
+
+#ifndef PI_CHECKPOINT_H_
+#define PI_CHECKPOINT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pi_engine.h"
+
+// EEPROM reserved for the checkpoint ring, the rest of it holds the
+// calibration table of the autotuner (see pi_autotune.h)
+#define CHECKPOINT_EEPROM_SIZE  1408
+
+// One saved state of a calculation. The records form a ring over the
+// whole checkpoint area, each checkpoint goes to the slot after the newest
+// one, so every cell is only written once per CHECKPOINT_SLOTS checkpoints.
+typedef struct {
+	uint16_t sequence;                // increases with every record
+	uint8_t engineIndex;
+	uint8_t batchIndex;
+	uint8_t targetIndex;
+	uint8_t active;                   // 0 once the run was stopped or finished
+	uint32_t iterations;
+	uint32_t milliseconds;
+	uint8_t state[ENGINE_STATE_SIZE];
+	uint16_t checksum;
+} checkpoint_t;
+
+#define CHECKPOINT_SLOTS  (CHECKPOINT_EEPROM_SIZE / sizeof(checkpoint_t))
+
+// Finds the newest valid record, has to run once before the other calls
+void checkpointInit(void);
+// Copies the newest record, false if there is none or its run ended
+bool checkpointLoad(checkpoint_t *record);
+// Writes the record as the new newest one, sequence and checksum are set here
+void checkpointSave(checkpoint_t *record);
+
+#endif /* PI_CHECKPOINT_H_ */
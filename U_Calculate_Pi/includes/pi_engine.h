@@ -0,0 +1,154 @@
+/*
+ * pi_engine.h
+ *
+ * Created: 17.10.2026 10:03:17
+ */ 
+
+
+#ifndef PI_ENGINE_H_
+#define PI_ENGINE_H_
+
+#include <stdint.h>
+#include "ff_math.h"
+
+// Scratch RAM for engines with large working arrays. Only the selected
+// engine uses it, so they all share the same block. Sized for the 1000
+// digits of Machin and Ramanujan, the largest block left in the 8 KB SRAM.
+#ifndef ENGINE_WORKSPACE_SIZE
+#define ENGINE_WORKSPACE_SIZE  2560
+#endif
+
+// Engine descriptors are only read, avr-gcc keeps them in flash instead
+// of copying them to SRAM at startup. The host build has no __flash.
+#if defined(__FLASH)
+#define ENGINE_CONST           const __flash
+#else
+#define ENGINE_CONST           const
+#endif
+
+// Number of most recent digits a digit producing engine hands out
+#define ENGINE_LATEST_DIGITS   20
+
+// Max. bytes of engine state saved in a checkpoint
+#define ENGINE_STATE_SIZE      48
+
+// Most digits a float estimate can certify
+#define ENGINE_FLOAT_DIGITS    8
+
+// Unit roundoff of float, every rounded operation is off by at most
+// this much relative to its exact result
+#define ENGINE_ROUNDOFF        5.9604645e-8
+
+// How the certified digits of an engine grow with its terms, lets the
+// autotuner extrapolate a short calibration run to larger targets
+typedef enum {
+	Convergence_None,              // never picked, e.g. random or hex digits
+	Convergence_Measured,          // finishes by itself, every target is measured
+	Convergence_Algebraic,         // digits grow with the logarithm of the terms
+	Convergence_Linear             // digits grow in proportion to the terms
+} engineConvergence_e;
+
+// Descriptor of one pi algorithm. The calculation task only talks to
+// an engine through these callbacks, engines never call into the kernel.
+typedef struct {
+	const char *name;              // shown on the display, max. 11 characters
+	uint16_t termsPerStep;         // series terms computed by one step
+	uint16_t batchLimit;           // max. steps per batch, 0 for no limit
+	uint8_t convergence;           // engineConvergence_e, for the autotuner
+	uint16_t maxDigits;            // most digits it certifies before rounding takes over
+	void (*init)(void);            // reset to the first term
+	uint16_t (*stepBatch)(uint16_t steps); // returns the steps done, 0 once finished
+	float (*estimate)(void);       // current approximation of pi
+	float (*errorBound)(void);     // upper bound of |estimate - pi|, rounding included
+	// Optional, for engines producing exact decimal digits. Copies the
+	// ENGINE_LATEST_DIGITS most recent ones and returns the digit count.
+	uint16_t (*digits)(char *latest);
+	// Set if those digits are hexadecimal, they certify no decimal digits
+	// and never reach a target
+	uint8_t hexDigits;
+	// Optional, series acceleration of the partial sums behind estimate
+	float (*accelerated)(void);
+	// Optional, for random engines whose errorBound guarantees nothing:
+	// half width of the 95% confidence interval around estimate
+	float (*confidence)(void);
+	// Optional engine setting (e.g. a start position), stepped with a long
+	// BUTTON3 press while stopped
+	const char *parameterName;
+	uint32_t (*getParameter)(void);
+	void (*stepParameter)(void);
+	// Optional, copy the complete engine state to and from at most
+	// ENGINE_STATE_SIZE bytes for checkpoints
+	void (*saveState)(uint8_t *state);
+	void (*loadState)(const uint8_t *state);
+	// Optional, name of the phase the next step runs for engines whose
+	// steps differ in kind, so a driver can time the phases separately
+	const char *(*phaseName)(void);
+} piEngine_t;
+
+extern uint32_t engineWorkspace[ENGINE_WORKSPACE_SIZE / 4];
+
+// Helpers for the ENGINE_LATEST_DIGITS buffer of digit producing engines
+void engineClearDigits(char *latest);
+void engineShiftDigit(char *latest, char digit);
+void engineCopyDigits(char *buffer, const char *latest);
+
+// Helpers for saveState / loadState, each returns the position after the
+// value it copied
+uint8_t *engineSaveValue(uint8_t *state, const void *value, uint8_t size);
+const uint8_t *engineLoadValue(const uint8_t *state, void *value, uint8_t size);
+
+// Leading digits of pi certified by value and its error bound: the digits
+// both ends of [value - errorBound, value + errorBound] share, at most
+// limit of them. They are written to latest like the digits of a digit
+// producing engine.
+uint8_t engineIntervalDigits(ffFloat_t value, float errorBound, char *latest, uint8_t limit);
+
+// Certified decimal digits of an engine, its exact digits if it produces
+// some, otherwise those its float estimate and error bound guarantee.
+// Hex digit engines only copy their latest digits and certify none.
+uint16_t engineCertifiedDigits(ENGINE_CONST piEngine_t *engine, char *latest);
+
+// Rounding error of a Kahan sum of terms whose magnitudes add up to at
+// most magnitude, not counting the errors of the terms themselves
+float engineKahanRounding(uint32_t terms, float magnitude);
+
+// Half the spacing of the floats around x, a float result cannot move
+// any more once everything still to be added stays below it
+float engineHalfUlp(float x);
+
+// Kahan summation: adds term to *sum, the low order part lost by the
+// addition is kept in *compensation and fed into the next one. The result
+// is *sum + *compensation. Unlike Neumaier's variant the compensation stays
+// below one ulp of the sum, so it survives millions of terms that are each
+// too small to change the sum on their own.
+static inline void engineCompensatedAdd(float *sum, float *compensation, float term) {
+	float y = term + *compensation;
+	float t = *sum + y;
+	
+	*compensation = y - (t - *sum);
+	*sum = t;
+}
+
+extern ENGINE_CONST piEngine_t leibnizEngine;
+extern ENGINE_CONST piEngine_t leibnizFixedEngine;
+extern ENGINE_CONST piEngine_t leibnizPairedEngine;
+extern ENGINE_CONST piEngine_t leibnizCompensatedEngine;
+extern ENGINE_CONST piEngine_t leibnizFloatFloatEngine;
+extern ENGINE_CONST piEngine_t wallisEngine;
+extern ENGINE_CONST piEngine_t wallisCompensatedEngine;
+extern ENGINE_CONST piEngine_t wallisIntegerEngine;
+extern ENGINE_CONST piEngine_t wallisFloatFloatEngine;
+extern ENGINE_CONST piEngine_t nilakanthaEngine;
+extern ENGINE_CONST piEngine_t vieteEngine;
+extern ENGINE_CONST piEngine_t spigotEngine;
+extern ENGINE_CONST piEngine_t bbpEngine;
+extern ENGINE_CONST piEngine_t machinEngine;
+extern ENGINE_CONST piEngine_t ramanujanEngine;
+extern ENGINE_CONST piEngine_t agmEngine;
+extern ENGINE_CONST piEngine_t monteCarloEngine;
+
+// All selectable engines, BUTTON4 cycles through them in this order
+extern ENGINE_CONST piEngine_t * ENGINE_CONST piEngines[];
+extern const uint8_t piEngineCount;
+
+#endif /* PI_ENGINE_H_ */
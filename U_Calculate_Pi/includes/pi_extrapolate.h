@@ -0,0 +1,37 @@
+/*
+ * pi_extrapolate.h
+ *
+ * Created: 17.10.2026 18:05:47
+ */ 
+
+
+#ifndef PI_EXTRAPOLATE_H_
+#define PI_EXTRAPOLATE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Samples kept for the extrapolation, the oldest one drops out
+#define EXTRAP_DEPTH  4
+// First term count that is sampled, later samples follow at twice the
+// previous count
+#define EXTRAP_MIN_N  16
+
+// Richardson extrapolation of estimates whose error is a power series in
+// 1/n, like Wallis' product or Leibniz' sums of term pairs. Any engine
+// can feed (n, estimate) pairs, only geometrically spaced ones are kept.
+typedef struct {
+	uint32_t n[EXTRAP_DEPTH];          // oldest first
+	float estimate[EXTRAP_DEPTH];
+	uint8_t count;
+	uint32_t nextN;
+} piExtrapolator_t;
+
+void extrapReset(piExtrapolator_t *extrap);
+// Returns true if the pair was kept as a new sample
+bool extrapFeed(piExtrapolator_t *extrap, uint32_t n, float estimate);
+// Best estimate and an error estimate, false while fewer than two
+// samples were kept
+bool extrapEstimate(const piExtrapolator_t *extrap, float *best, float *error);
+
+#endif /* PI_EXTRAPOLATE_H_ */
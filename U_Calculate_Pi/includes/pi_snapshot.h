@@ -0,0 +1,51 @@
+/*
+ * pi_snapshot.h
+ *
+ * Created: 17.10.2026 09:12:31
+ */ 
+
+
+#ifndef PI_SNAPSHOT_H_
+#define PI_SNAPSHOT_H_
+
+#include <stdint.h>
+#include "pi_engine.h"
+
+// One published state of a calculation
+typedef struct {
+	float estimate;
+	float accelerated;                    // accelerated estimate, if the engine has one
+	float best;                           // extrapolated estimate, else the raw one
+	float bestError;                      // error estimate of best
+	float confidence;                     // 95% interval of random engines, else 0
+	uint32_t iterations;
+	uint32_t milliseconds;
+	float errorBound;                     // achieved precision once finished
+	uint8_t finished;                     // engine can not improve any more
+	uint32_t endTick;                     // kernel tick the run finished at
+	uint8_t targetReached;                // precision target reached, the
+	uint32_t targetIterations;            // terms and exact time when that
+	uint32_t targetMilliseconds;          // happened first
+	uint16_t targetMicroseconds;
+	uint16_t digits;                      // exact digits, 0 for series engines
+	uint16_t certified;                   // digits guaranteed by the error bound
+	uint16_t batchDigits;                 // digits gained by the last batch
+	uint32_t batchMilliseconds;           // time taken by the last batch
+	char latest[ENGINE_LATEST_DIGITS];    // most recent of the certified digits
+} piSample_t;
+
+// Two alternating sample buffers guarded by a sequence counter.
+// The writer fills the buffer that is not currently published and then
+// advances the sequence, the reader retries if the sequence moved while
+// it was copying. Neither side calls into the kernel or ever waits on
+// the other one.
+typedef struct {
+	volatile uint8_t sequence;
+	piSample_t buffer[2];
+} piSnapshot_t;
+
+void snapshotReset(piSnapshot_t *snapshot);
+void snapshotPublish(piSnapshot_t *snapshot, const piSample_t *sample);
+void snapshotRead(piSnapshot_t *snapshot, piSample_t *sample);
+
+#endif /* PI_SNAPSHOT_H_ */
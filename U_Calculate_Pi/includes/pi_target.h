@@ -0,0 +1,26 @@
+/*
+ * pi_target.h
+ *
+ * Created: 18.10.2026 09:14:52
+ */ 
+
+
+#ifndef PI_TARGET_H_
+#define PI_TARGET_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Digits of pi kept in flash to check results against
+#define TARGET_REFERENCE_DIGITS  1000
+
+// Correct digits at which the time to target is taken, ascending
+#define TARGET_COUNT             7
+extern const uint16_t targetDigits[TARGET_COUNT];
+
+// True once the given count of digits, the leading 3 included, is
+// certified (see engineCertifiedDigits) and the latest of them match the
+// reference. Beyond the reference only the digit count is checked.
+bool targetReached(uint16_t digits, uint16_t certified, const char *latest);
+
+#endif /* PI_TARGET_H_ */
@@ -0,0 +1,29 @@
+/*
+ * recip_math.h
+ *
+ * Created: 18.10.2026 20:31:08
+ */ 
+
+
+#ifndef RECIP_MATH_H_
+#define RECIP_MATH_H_
+
+#include <stdint.h>
+
+// Reciprocals of integers without a division: an 8 bit seed from a flash
+// table, a 16 bit and a 32 bit Newton step and, where the result needs it,
+// an exact correction with the remainder. The 32 x 32 bit products run on
+// the hardware multiplier of the XMEGA.
+
+// Largest distance of ulReciprocalEstimate() from floor(2^63 / d),
+// checked for every normalised divisor
+#define RECIP_ESTIMATE_ERROR  4
+
+// floor(2^63 / d) to within RECIP_ESTIMATE_ERROR for a normalised divisor
+// 2^31 < d < 2^32, without the exact correction
+uint32_t ulReciprocalEstimate(uint32_t d);
+// 1 / d rounded to nearest, the same float as 1.0 / d for d < 2^24 and
+// exact for larger d where the conversion to float would round first
+float fReciprocal(uint32_t d);
+
+#endif /* RECIP_MATH_H_ */
@@ -6,6 +6,7 @@
  */ 
 
 #include <stdio.h>
+#include <string.h>
 #include <limits.h>
 #include "avr_compiler.h"
 #include "pmic_driver.h"
@@ -18,6 +19,7 @@
 #include "task.h"
 #include "queue.h"
 #include "event_groups.h"
+#include "timers.h"
 #include "stack_macros.h"
 
 #include "mem_check.h"
@@ -28,45 +30,215 @@
 #include "NHD0420Driver.h"
 
 #include "rtos_buttonhandler.h"
+#include "pi_snapshot.h"
+#include "pi_engine.h"
+#include "pi_extrapolate.h"
+#include "pi_target.h"
+#include "pi_checkpoint.h"
+#include "pi_autotune.h"
+#include "recip_math.h"
 
 #define N_TIME_TICK  (1 << 0)
 #define N_TIME_RST   (1 << 1)
 #define N_CALC_START (1 << 0)
 #define N_CALC_STOP  (1 << 1)
 #define N_CALC_RST   (1 << 2)
-#define EG_CALC_RELEASED (1 << 0)
+#define N_CALC_RACE  (1 << 3)
+#define N_CALC_RESUME (1 << 4)
+#define N_CALC_CALIBRATE (1 << 5)
+#define N_CALC_BENCHMARK (1 << 6)
+#define N_CALC_TURN  (1 << 7)
 
-#define PI_5DECIMALS        3.14159
 #define INTERRUPT_PERIOD_MS 5
+// TCC1 runs at 32 MHz / 64
+#define TIMER_COUNTS_PER_MS 500
+#define CYCLES_PER_TICK     (configCPU_CLOCK_HZ / configTICK_RATE_HZ)
+#define CYCLES_PER_TIMER_COUNT  64
+
+// Shortest time between two checkpoints. The calculation task also keeps
+// at least CHECKPOINT_COST_FACTOR times the duration of the last EEPROM
+// write between two of them, which holds the write cost below 1%.
+#ifndef CHECKPOINT_MIN_INTERVAL_MS
+#define CHECKPOINT_MIN_INTERVAL_MS  10000
+#endif
+#define CHECKPOINT_COST_FACTOR      100
+
+// Longest calibration run of an engine the autotuner extrapolates and of
+// one that can only be measured. Targets a measured engine does not reach
+// in its run are left out of the table instead of holding up the boot.
+#define CALIBRATION_RUN_MS      3000
+#define CALIBRATION_MEASURE_MS  5000
+// Batches of a calibration run double from one step up to this size
+#define CALIBRATION_MAX_BATCH   1024
+
+// Reciprocal benchmark: calls per round, few enough that the timer
+// overflows at most once while interrupts are off, and rounds
+#define BENCHMARK_CALLS         64
+#define BENCHMARK_ROUNDS        16
+// Distance of the first denominators of two rounds, all stay below 2^24
+#define BENCHMARK_SPREAD        1048573UL
+
+// Task stacks in bytes (StackType_t is uint8_t). Every stack also takes
+// the saved context (37 bytes) and the tick and TCC1 interrupts nested on
+// top of the deepest call (about 60). Check them with View_Memory after
+// a run, see configTOTAL_HEAP_SIZE for the whole budget.
+// vInterface: a piSample_t, six line buffers and a TaskStatus_t (about
+// 270 bytes), below it the float printf (about 110)
+#define INTERFACE_STACK_SIZE  480
+// vCalculate: a piSample_t and the extrapolator (about 170 bytes), below
+// it a checkpoint record or the multiple precision and float routines
+// of an engine step (about 110)
+#define CALCULATE_STACK_SIZE  450
+// vRaceLane: the latest digits of a lane (about 50 bytes) and an engine
+// step or the interval digits of its float estimate (about 100)
+#define LANE_STACK_SIZE       300
+// vTimeHandler only waits for notifications
+#define TIME_STACK_SIZE       150
+
+// heap_1 never frees, the heap holds the stack and the TCB (50 bytes with
+// the run time stats and notifications) of all ten tasks, those of the
+// display and button drivers and the kernel included, and the queues,
+// mutexes and event group of the drivers (about 390 bytes). View_Memory
+// shows how much of it was never taken.
+#define TASK_TCB_SIZE         50
+#define KERNEL_OBJECTS_SIZE   390
+#define TASK_STACKS_SIZE      (INTERFACE_STACK_SIZE + CALCULATE_STACK_SIZE + 2 * LANE_STACK_SIZE + TIME_STACK_SIZE \
+	+ 2 * (configMINIMAL_STACK_SIZE + 50) + configMINIMAL_STACK_SIZE + 150 + configMINIMAL_STACK_SIZE + configTIMER_TASK_STACK_DEPTH)
+
+// configMINIMAL_STACK_SIZE is a cast, which #if cannot evaluate
+_Static_assert(TASK_STACKS_SIZE + 10 * TASK_TCB_SIZE + KERNEL_OBJECTS_SIZE <= configTOTAL_HEAP_SIZE,
+	"configTOTAL_HEAP_SIZE too small for the task stacks");
+
+// Engines racing each other, one per display line of the scoreboard
+#define RACE_LANES          3
+// Steps a lane computes between two checks of its slice
+#define RACE_BATCH          16
 
 typedef enum {
 	State_Started,
-	State_Stopped
+	State_Stopped,
+	State_Racing,
+	State_Resume,                         // asking whether to resume a checkpoint
+	State_Auto,                           // the autotuner picks the engine
+	State_Calibrating,                    // timing every engine for the autotuner
+	State_Benchmark                       // cycles of the reciprocal kernel
 } State_e;
 
+// Ways of computing 1 / d the benchmark compares, the plain loop is
+// subtracted from the others
+typedef enum {
+	Bench_Loop,
+	Bench_Kernel,                         // fReciprocal()
+	Bench_Divide,                         // __divsf3 alone
+	Bench_ConvertDivide,                  // conversion and division as the engines did
+	Bench_Count
+} Bench_e;
+
+// Content of the first display line while running (View_Memory and
+// View_Stacks use three lines), switched with BUTTON3
 typedef enum {
-	LEIBNIZ,
-	WALLIS,
-} Algorithm_e;
+	View_Rates,
+	View_Best,
+	View_Target,
+	View_Digits,                          // what the last batch of a digit engine gained
+	View_Memory,                          // free SRAM and heap, free stack of the tasks
+	View_Stacks,                          // free stack of the driver and kernel tasks
+	View_Count
+} View_e;
 
-Algorithm_e algorithm = LEIBNIZ;
-TaskHandle_t leibnizHandle;
-TaskHandle_t wallisHandle;
+// Index into piEngines[], selected with BUTTON4 while stopped
+uint8_t engineIndex = 0;
+TaskHandle_t calculateHandle;
 TaskHandle_t timeHandle;
+TaskHandle_t buttonHandle;
 State_e state = State_Stopped;
-EventGroupHandle_t xEventGroup;
 
-float pi;
-unsigned milliseconds;
+// Number of engine steps the calculation task computes between two stop
+// checks and publications of pi. Selectable with BUTTON3 while stopped.
+const uint16_t batchSizes[] = { 1, 16, 128, 1024 };
+uint8_t batchIndex = 0;
+
+View_e view = View_Rates;
+
+// Index into targetDigits[], selected with a long BUTTON4 press while
+// stopped among the targets the selected engine can certify
+uint8_t targetIndex = 1;
+
+// Time budget of the autotuner in seconds, 0 for none, selected with
+// BUTTON3 in State_Auto
+const uint16_t autoBudgets[] = { 0, 1, 10, 60, 600 };
+uint8_t autoBudgetIndex = 0;
+
+// Engine the calibration is timing and the state to return to after it
+volatile uint8_t calibrationIndex;
+State_e calibrationReturn = State_Stopped;
+autotuneRun_t xCalibrationRun;
+
+// Cycles per call of every benchmark variant and the calls in which
+// fReciprocal() and the float division disagreed, set once benchDone
+volatile uint16_t benchCycles[Bench_Count];
+volatile uint16_t benchMismatches;
+volatile uint8_t benchDone;
+// Takes every benchmarked result so that none is optimised away
+volatile float benchSink;
+
+// One engine of a race. Engines of the same family share their static
+// state and the large ones share engineWorkspace, so every lane has to
+// come from a different family and at most one may use the workspace.
+// Lane 0 runs in the calculation task, the others in their own tasks.
+typedef struct {
+	ENGINE_CONST piEngine_t *engine;
+	TaskHandle_t handle;
+	uint32_t runTimeStart;                // run time counter of the task at the start
+	volatile uint32_t iterations;
+	volatile uint32_t targetMilliseconds;
+	volatile uint8_t targetReached;
+	volatile uint8_t finished;
+} raceLane_t;
+
+raceLane_t raceLanes[RACE_LANES] = {
+	{ .engine = &spigotEngine },
+	{ .engine = &leibnizPairedEngine },
+	{ .engine = &wallisIntegerEngine },
+};
+
+// Time slice in ticks a lane keeps the CPU before it passes the turn on,
+// selected with a long BUTTON2 press while stopped
+const uint8_t raceSlices[] = { 1, 2, 5, 10, 20 };
+uint8_t raceSliceIndex = 2;
+// Lane holding the CPU and the tick its slice started
+volatile uint8_t raceTurn;
+volatile TickType_t raceSliceStart;
+// Set by vRaceStop(), read by the lane holding the turn between batches
+volatile bool raceStopped;
+uint32_t raceRunTimeStart;
+
+// Checkpoint found at boot, the calculation task resumes from it
+checkpoint_t xResumeRecord;
+
+piSnapshot_t xPiSnapshot;
+TickType_t xCalcStartTick;
+volatile uint32_t milliseconds;
+// Value milliseconds restarts from on N_TIME_RST
+volatile uint32_t millisecondsStart;
+// TCC1 overflows since the start, counted in the ISR itself so that
+// together with TCC1.CNT it gives the exact time
+volatile uint32_t timerPeriods;
+// ulTimerCounts() at the last vTimerStart(), runs are timed from there
+uint32_t timerStartCounts;
 
 extern void vApplicationIdleHook(void);
-void vCalculateLeibniz(void *pvParameters);
-void vCalculateWallis(void *pvParameters);
+void vCalculate(void *pvParameters);
 void vInterface(void *pvParameters);
 void vButtonHandler(void *pvParameters);
 void vTimeHandler(void *pvParameters);
+void vRaceLane(void *pvParameters);
+
+static uint32_t ulGetMilliseconds(void);
+static uint8_t ucReachableTarget(ENGINE_CONST piEngine_t *engine, uint8_t index);
 
 ISR(TCC1_OVF_vect) {
+	timerPeriods++;
 	xTaskNotifyFromISR(timeHandle, N_TIME_TICK, eSetBits, pdFALSE);
 }
 
@@ -78,21 +250,95 @@ void vInitTimer() {
 	TCC1.CTRLA = 0x00;
 	TCC1.CTRLB = 0x00;
 	TCC1.INTCTRLA = 0x03;
-	TCC1.PER = 500 * INTERRUPT_PERIOD_MS;
+	TCC1.PER = TIMER_COUNTS_PER_MS * INTERRUPT_PERIOD_MS;
+}
+
+// Timer counts since boot, interrupts have to be disabled. An overflow
+// that happened but whose ISR did not run yet is recognised by its
+// pending flag together with a small count.
+static uint32_t ulTimerCounts(void) {
+	uint32_t ulPeriods = timerPeriods;
+	uint16_t usCount = TCC1.CNT;
+	
+	if ((TCC1.INTFLAGS & TC1_OVFIF_bm) && usCount < TIMER_COUNTS_PER_MS * INTERRUPT_PERIOD_MS / 2) {
+		ulPeriods++;
+	}
+	
+	return ulPeriods * (TIMER_COUNTS_PER_MS * INTERRUPT_PERIOD_MS) + usCount;
+}
+
+// TCC1 is never reset, it is also the clock of the run time stats, which
+// the tick interrupt reads at any time. A run only remembers where it
+// started.
+static void vTimerStart(void) {
+	taskENTER_CRITICAL();
+	timerStartCounts = ulTimerCounts();
+	TCC1.CTRLA = TC_CLKSEL_DIV64_gc;
+	taskEXIT_CRITICAL();
+}
+
+static void vTimerStop(void) {
+	TCC1.CTRLA = 0x00;
+}
+
+// Timer counts since vTimerStart(), interrupts have to be disabled
+static uint32_t ulTimerElapsed(void) {
+	return ulTimerCounts() - timerStartCounts;
+}
+
+// Time since vTimerStart() to the timer count
+static void vTimerLatch(uint32_t *pulMilliseconds, uint16_t *pusMicroseconds) {
+	uint32_t ulCounts;
+	
+	taskENTER_CRITICAL();
+	ulCounts = ulTimerElapsed();
+	taskEXIT_CRITICAL();
+	
+	*pulMilliseconds = ulCounts / TIMER_COUNTS_PER_MS;
+	*pusMicroseconds = (ulCounts % TIMER_COUNTS_PER_MS) * (1000 / TIMER_COUNTS_PER_MS);
+}
+
+// Time base of the FreeRTOS run time stats, called by the kernel with
+// interrupts disabled. It only advances while TCC1 runs, the race takes
+// its own start values.
+uint32_t ulRunTimeCounter(void) {
+	return ulTimerCounts();
 }
 
 int main(void) {
+	resetReason_t xResetReason = getResetReason();
+	
 	vInitClock();
 	vInitDisplay();
 	vInitTimer();
 	
-	xEventGroup = xEventGroupCreate();
+	snapshotReset(&xPiSnapshot);
+	
+	// A run cut short by the error handler's software reset or a power
+	// loss can be resumed, a reset from the debugger starts clean
+	checkpointInit();
+	if (xResetReason != RESETREASON_DEBUGGERRESET && checkpointLoad(&xResumeRecord) && xResumeRecord.engineIndex < piEngineCount) {
+		engineIndex = xResumeRecord.engineIndex;
+		batchIndex = xResumeRecord.batchIndex;
+		targetIndex = xResumeRecord.targetIndex;
+		state = State_Resume;
+	}
+	targetIndex = ucReachableTarget(piEngines[engineIndex], targetIndex);
+	
+	// The engines are timed once per clock setup, the calculation task
+	// does it first thing and then offers the checkpoint
+	if (!autotuneInit()) {
+		calibrationReturn = state;
+		state = State_Calibrating;
+	}
 	
-	xTaskCreate(vInterface, (const char *) "interface", configMINIMAL_STACK_SIZE + 50, NULL, 2, NULL);
-	xTaskCreate(vButtonHandler, (const char *) "buttonHandler", configMINIMAL_STACK_SIZE + 50, NULL, 2, NULL);
-	xTaskCreate(vTimeHandler, (const char *) "timeHandler", configMINIMAL_STACK_SIZE + 50, NULL, 2, &timeHandle);
-	xTaskCreate(vCalculateLeibniz, (const char *) "calculateLeibniz", configMINIMAL_STACK_SIZE+10, NULL, 1, &leibnizHandle);
-	xTaskCreate(vCalculateWallis, (const char *) "calculateWallis", configMINIMAL_STACK_SIZE+10, NULL, 1, &wallisHandle);
+	xTaskCreate(vInterface, (const char *) "interface", INTERFACE_STACK_SIZE, NULL, 2, NULL);
+	xTaskCreate(vButtonHandler, (const char *) "buttonHandler", configMINIMAL_STACK_SIZE + 50, NULL, 2, &buttonHandle);
+	xTaskCreate(vTimeHandler, (const char *) "timeHandler", TIME_STACK_SIZE, NULL, 2, &timeHandle);
+	xTaskCreate(vCalculate, (const char *) "calculate", CALCULATE_STACK_SIZE, NULL, 1, &calculateHandle);
+	raceLanes[0].handle = calculateHandle;
+	xTaskCreate(vRaceLane, (const char *) "lane1", LANE_STACK_SIZE, &raceLanes[1], 1, &raceLanes[1].handle);
+	xTaskCreate(vRaceLane, (const char *) "lane2", LANE_STACK_SIZE, &raceLanes[2], 1, &raceLanes[2].handle);
 	
 	vTaskStartScheduler();
 	
@@ -108,7 +354,7 @@ void vTimeHandler(void *pvParameters) {
 		xResult = xTaskNotifyWait(pdFALSE, N_TIME_TICK | N_TIME_RST, &ulNotifyValue, portMAX_DELAY);
 		if (xResult == pdPASS) {
 			if (ulNotifyValue & N_TIME_RST) {
-				milliseconds = 0;
+				milliseconds = millisecondsStart;
 			}
 			
 			if (ulNotifyValue & N_TIME_TICK) {
@@ -118,51 +364,294 @@ void vTimeHandler(void *pvParameters) {
 	}
 }
 
+// milliseconds is written by vTimeHandler, which can preempt the
+// calculation tasks in the middle of reading the 32-bit value
+static uint32_t ulGetMilliseconds(void) {
+	uint32_t ulValue;
+	
+	do {
+		ulValue = milliseconds;
+	} while (ulValue != milliseconds);
+	
+	return ulValue;
+}
+
+// Writes the certified digits of a series engine as 3.14..., at most
+// ENGINE_FLOAT_DIGITS of them
+static void vFormatCertified(char *pcText, const piSample_t *pxSample) {
+	const char *pcDigits = &pxSample->latest[ENGINE_LATEST_DIGITS - pxSample->certified];
+	uint8_t k;
+	
+	if (pxSample->certified == 0 || pxSample->certified > ENGINE_FLOAT_DIGITS) {
+		strcpy_P(pcText, PSTR("-"));
+		return;
+	}
+	
+	*pcText++ = pcDigits[0];
+	if (pxSample->certified > 1) {
+		*pcText++ = '.';
+	}
+	for (k = 1; k < pxSample->certified; k++) {
+		*pcText++ = pcDigits[k];
+	}
+	*pcText = '\0';
+}
+
+// Writes a text kept in flash, the display driver only reads SRAM
+static void vDisplayWriteFlash(int line, int pos, const char *pcText) {
+	char cLine[21];
+	
+	strncpy_P(cLine, pcText, sizeof(cLine) - 1);
+	cLine[sizeof(cLine) - 1] = '\0';
+	vDisplayWriteStringAtPos(line, pos, cLine);
+}
+
+// Bytes of the stack of xTask (NULL for the caller) never used so far.
+// uxTaskGetStackHighWaterMark() returns them as UBaseType_t, which is
+// 8 bits on this port and cuts off everything above 255.
+static uint16_t usStackFree(TaskHandle_t xTask) {
+	TaskStatus_t xStatus;
+	
+	vTaskGetInfo(xTask, &xStatus, pdTRUE, eInvalid);
+	return xStatus.usStackHighWaterMark;
+}
+
+// The same for a task without a handle in main.c, by its name as stored
+// (cut to configMAX_TASK_NAME_LEN - 1 characters). 0 until it exists.
+static uint16_t usNamedStackFree(const char *pcName) {
+	TaskHandle_t xTask = xTaskGetHandle(pcName);
+	
+	return xTask != NULL ? usStackFree(xTask) : 0;
+}
+
 void vInterface(void *pvParameters) {
-	char cPi[15];
-	char cTime[14];
+	char cPi[21];
+	char cCertified[ENGINE_FLOAT_DIGITS + 2];
+	char cTime[21];
+	char cCycles[21];
+	char cEngine[21];
+	char cDigits[ENGINE_LATEST_DIGITS + 1];
+	piSample_t xSample;
+	TickType_t xElapsed;
+	uint32_t ulCyclesPerTerm;
+	uint32_t ulTermsPerSecond;
+	uint32_t ulDigitsPerSecond;
+	TaskStatus_t xStatus;
+	uint32_t ulRaceTime;
+	uint32_t ulCpuShare;
+	uint32_t ulPredicted;
+	uint8_t ucAutoTarget;
+	uint8_t ucAutoEngine;
+	uint8_t k;
 	TickType_t xLastWakeTime;
 	const TickType_t xFrequency = 500 / portTICK_RATE_MS;
 	xLastWakeTime = xTaskGetTickCount();
 	
 	for(;;) {
 		vDisplayClear();
-		vDisplayWriteStringAtPos(0, 0, "Calculate PI");
+		vDisplayWriteFlash(0, 0, PSTR("Calculate PI"));
 		
 		switch (state) {
 			case State_Started:
-				// Wait for PI to be released from the calculation task
-				xEventGroupWaitBits(xEventGroup, EG_CALC_RELEASED, pdTRUE, pdTRUE, portMAX_DELAY);
+				if (view == View_Memory) {
+					// The SRAM between the static data (the heap included) and
+					// the lowest use of the startup stack, the heap never taken
+					// and the bytes of stack the tasks never touched so far
+					snprintf_P(cCycles, sizeof(cCycles), PSTR("Free %u Heap %u"), get_mem_unused(), xPortGetFreeHeapSize());
+					vDisplayWriteStringAtPos(0, 0, cCycles);
+					snprintf_P(cEngine, sizeof(cEngine), PSTR("Calc %u Intf %u"), usStackFree(calculateHandle), usStackFree(NULL));
+					vDisplayWriteStringAtPos(1, 0, cEngine);
+					snprintf_P(cTime, sizeof(cTime), PSTR("Lane %u %u Btn %u"), usStackFree(raceLanes[1].handle), usStackFree(raceLanes[2].handle), usStackFree(buttonHandle));
+					vDisplayWriteStringAtPos(2, 0, cTime);
+					vDisplayWriteFlash(3, 0, PSTR("      STOP VIEW     "));
+					break;
+				}
+				if (view == View_Stacks) {
+					snprintf_P(cCycles, sizeof(cCycles), PSTR("Time %u Disp %u"), usStackFree(timeHandle), usNamedStackFree("dispUpd"));
+					vDisplayWriteStringAtPos(0, 0, cCycles);
+					snprintf_P(cEngine, sizeof(cEngine), PSTR("Keys %u Idle %u"), usNamedStackFree("buttonH"), usStackFree(xTaskGetIdleTaskHandle()));
+					vDisplayWriteStringAtPos(1, 0, cEngine);
+					snprintf_P(cTime, sizeof(cTime), PSTR("Timer %u"), usStackFree(xTimerGetTimerDaemonTaskHandle()));
+					vDisplayWriteStringAtPos(2, 0, cTime);
+					vDisplayWriteFlash(3, 0, PSTR("      STOP VIEW     "));
+					break;
+				}
 				
-				if (algorithm == LEIBNIZ) {
-					sprintf(cPi, "PI: %0.8f", pi * 4);
-				} else {
-					sprintf(cPi, "PI: %0.8f", pi);
+				// Take a consistent copy of the latest published state,
+				// this never waits for the calculation task
+				snapshotRead(&xPiSnapshot, &xSample);
+				
+				// Only the digits the error bound guarantees, they never change
+				// once shown
+				vFormatCertified(cCertified, &xSample);
+				snprintf_P(cPi, sizeof(cPi), PSTR("PI: %-9s %u cert"), cCertified, xSample.certified);
+				if (xSample.confidence > 0) {
+					// Random engines certify nothing, they show the estimate
+					// with its 95% confidence interval instead
+					snprintf_P(cPi, sizeof(cPi), PSTR("PI: %0.6f +-%.0e"), xSample.estimate, xSample.confidence);
+				}
+				
+				// Average CPU cycles per term and terms per second since start,
+				// including the RTOS overhead paid once per batch. A finished
+				// run is timed up to the tick it ended at.
+				xElapsed = (xSample.finished ? xSample.endTick : xTaskGetTickCount()) - xCalcStartTick;
+				ulCyclesPerTerm = 0;
+				ulTermsPerSecond = 0;
+				if (xSample.iterations > 0) {
+					ulCyclesPerTerm = ((uint64_t) xElapsed * CYCLES_PER_TICK) / xSample.iterations;
+				}
+				if (xElapsed > 0) {
+					ulTermsPerSecond = ((uint64_t) xSample.iterations * configTICK_RATE_HZ) / xElapsed;
 				}
 				
-				sprintf(cTime, "Time: %ims", milliseconds);
+				if (view == View_Target) {
+					// Time and terms at which the target was first reached,
+					// separate from the total run time on line 2
+					if (xSample.targetReached) {
+						snprintf_P(cCycles, sizeof(cCycles), PSTR("T%u %lu.%03ums %lut"), targetDigits[targetIndex], xSample.targetMilliseconds, xSample.targetMicroseconds, xSample.targetIterations);
+					} else if (piEngines[engineIndex]->hexDigits) {
+						snprintf_P(cCycles, sizeof(cCycles), PSTR("T%u: hex digits"), targetDigits[targetIndex]);
+					} else {
+						snprintf_P(cCycles, sizeof(cCycles), PSTR("T%u not reached"), targetDigits[targetIndex]);
+					}
+				} else if (view == View_Digits && xSample.digits > 0) {
+					// Digit engines report what the last batch gained and how long it took
+					snprintf_P(cCycles, sizeof(cCycles), PSTR("+%u dig in %lums"), xSample.batchDigits, xSample.batchMilliseconds);
+				} else if (view == View_Best) {
+					snprintf_P(cCycles, sizeof(cCycles), PSTR("R %0.7f +-%.0e"), xSample.best, xSample.bestError);
+				} else if (piEngines[engineIndex]->accelerated != NULL) {
+					// Accelerated value above the raw partial sum on the next line
+					snprintf_P(cCycles, sizeof(cCycles), PSTR("ACC: %0.8f"), xSample.accelerated);
+				} else if (piEngines[engineIndex]->confidence != NULL) {
+					// A term of a random engine is one sample
+					snprintf_P(cCycles, sizeof(cCycles), PSTR("%lucyc %lusmp/s"), ulCyclesPerTerm, ulTermsPerSecond);
+				} else {
+					snprintf_P(cCycles, sizeof(cCycles), PSTR("%lucyc/t %lut/s"), ulCyclesPerTerm, ulTermsPerSecond);
+				}
+				vDisplayWriteStringAtPos(0, 0, cCycles);
 				
-				vDisplayWriteStringAtPos(1, 0, cPi);
+				if (xSample.digits > 0) {
+					// Digit engines show their latest exact digits instead of the float,
+					// and how many of them they produce per second
+					memcpy(cDigits, xSample.latest, ENGINE_LATEST_DIGITS);
+					cDigits[ENGINE_LATEST_DIGITS] = '\0';
+					ulDigitsPerSecond = 0;
+					if (xSample.milliseconds > 0) {
+						ulDigitsPerSecond = ((uint32_t) xSample.digits * 1000) / xSample.milliseconds;
+					}
+					// Seconds with a tenth leave room for the rate on the 20 columns
+					snprintf_P(cTime, sizeof(cTime), PSTR("%lu.%lus %ud %lud/s"), xSample.milliseconds / 1000, (xSample.milliseconds / 100) % 10, xSample.digits, ulDigitsPerSecond);
+					vDisplayWriteStringAtPos(1, 0, cDigits);
+				} else {
+					if (xSample.finished) {
+						// Target certified or further terms could not change the
+						// result, show what it reached
+						snprintf_P(cTime, sizeof(cTime), PSTR("%lums +-%.1e"), xSample.milliseconds, xSample.errorBound);
+					} else {
+						snprintf_P(cTime, sizeof(cTime), PSTR("Time: %lums"), xSample.milliseconds);
+					}
+					vDisplayWriteStringAtPos(1, 0, cPi);
+				}
 				vDisplayWriteStringAtPos(2, 0, cTime);
-				vDisplayWriteStringAtPos(3, 0, "START STOP     CHNG");
+				vDisplayWriteFlash(3, 0, PSTR("      STOP VIEW     "));
 				break;
 				
-			case State_Stopped:
-				switch (algorithm) {
-					case LEIBNIZ:
-						vDisplayWriteStringAtPos(1, 0, "Current: Leibniz");
-						break;
-						
-					case WALLIS:
-						vDisplayWriteStringAtPos(1, 0, "Current: Wallis");
-						break;
+			case State_Racing:
+				// Scoreboard: time to target and CPU share of every lane
+				snprintf_P(cCycles, sizeof(cCycles), PSTR("Race T%u %ums %lus"), targetDigits[targetIndex], raceSlices[raceSliceIndex], ulGetMilliseconds() / 1000);
+				vDisplayWriteStringAtPos(0, 0, cCycles);
+				
+				taskENTER_CRITICAL();
+				ulRaceTime = ulRunTimeCounter() - raceRunTimeStart;
+				taskEXIT_CRITICAL();
+				
+				for (k = 0; k < RACE_LANES; k++) {
+					vTaskGetInfo(raceLanes[k].handle, &xStatus, pdFALSE, eInvalid);
+					ulCpuShare = 0;
+					if (ulRaceTime >= 100) {
+						ulCpuShare = (xStatus.ulRunTimeCounter - raceLanes[k].runTimeStart) / (ulRaceTime / 100);
+					}
 					
-					default:
-						vDisplayWriteStringAtPos(1, 0, "Current: None");
-						break;
+					if (raceLanes[k].targetReached) {
+						snprintf_P(cTime, sizeof(cTime), PSTR("%lums"), raceLanes[k].targetMilliseconds);
+					} else if (raceLanes[k].finished) {
+						strcpy_P(cTime, PSTR("end"));
+					} else {
+						strcpy_P(cTime, PSTR("---"));
+					}
+					snprintf_P(cEngine, sizeof(cEngine), PSTR("%-6.6s%8s %3lu%%%%"), raceLanes[k].engine->name, cTime, ulCpuShare);
+					vDisplayWriteStringAtPos(k + 1, 0, cEngine);
+				}
+				break;
+				
+			case State_Stopped:
+				snprintf_P(cCycles, sizeof(cCycles), PSTR("Target %u Slice %ums"), targetDigits[targetIndex], raceSlices[raceSliceIndex]);
+				vDisplayWriteStringAtPos(0, 0, cCycles);
+				
+				snprintf_P(cEngine, sizeof(cEngine), PSTR("Current: %s"), piEngines[engineIndex]->name);
+				vDisplayWriteStringAtPos(1, 0, cEngine);
+				
+				if (piEngines[engineIndex]->getParameter != NULL) {
+					snprintf_P(cCycles, sizeof(cCycles), PSTR("Batch: %u %s=%lu"), batchSizes[batchIndex], piEngines[engineIndex]->parameterName, piEngines[engineIndex]->getParameter());
+				} else {
+					snprintf_P(cCycles, sizeof(cCycles), PSTR("Batch: %u"), batchSizes[batchIndex]);
+				}
+				vDisplayWriteStringAtPos(2, 0, cCycles);
+				vDisplayWriteFlash(3, 0, PSTR("START AUTO BTCH CHNG"));
+				break;
+				
+			case State_Auto:
+				// Fastest engine for the target, or for the largest target
+				// some engine still reaches within the budget
+				if (autoBudgets[autoBudgetIndex] == 0) {
+					snprintf_P(cCycles, sizeof(cCycles), PSTR("Auto T%u Bdgt none"), targetDigits[targetIndex]);
+				} else {
+					snprintf_P(cCycles, sizeof(cCycles), PSTR("Auto T%u Bdgt %us"), targetDigits[targetIndex], autoBudgets[autoBudgetIndex]);
+				}
+				vDisplayWriteStringAtPos(0, 0, cCycles);
+				
+				ucAutoTarget = targetIndex;
+				if (autotunePick(&ucAutoTarget, autoBudgets[autoBudgetIndex] * 1000UL, &ucAutoEngine, &ulPredicted)) {
+					snprintf_P(cEngine, sizeof(cEngine), PSTR("Best: %s"), piEngines[ucAutoEngine]->name);
+					snprintf_P(cTime, sizeof(cTime), PSTR("T%u in %lums"), targetDigits[ucAutoTarget], ulPredicted);
+				} else {
+					strcpy_P(cEngine, PSTR("No engine reaches"));
+					snprintf_P(cTime, sizeof(cTime), PSTR("T%u in time"), targetDigits[targetIndex]);
+				}
+				vDisplayWriteStringAtPos(1, 0, cEngine);
+				vDisplayWriteStringAtPos(2, 0, cTime);
+				vDisplayWriteFlash(3, 0, PSTR("START BACK BDGT TRGT"));
+				break;
+				
+			case State_Calibrating:
+				snprintf_P(cCycles, sizeof(cCycles), PSTR("Calibrating %u/%u"), calibrationIndex + 1, autotuneEngineCount());
+				vDisplayWriteStringAtPos(0, 0, cCycles);
+				vDisplayWriteStringAtPos(1, 0, piEngines[calibrationIndex]->name);
+				vDisplayWriteFlash(2, 0, PSTR("Timing the engines"));
+				vDisplayWriteFlash(3, 0, PSTR("for auto selection"));
+				break;
+				
+			case State_Benchmark:
+				if (!benchDone) {
+					vDisplayWriteFlash(1, 0, PSTR("Timing reciprocals"));
+					break;
 				}
+				snprintf_P(cCycles, sizeof(cCycles), PSTR("Recip cyc, %u diff"), benchMismatches);
+				vDisplayWriteStringAtPos(0, 0, cCycles);
+				snprintf_P(cEngine, sizeof(cEngine), PSTR("Newton %4u div %4u"), benchCycles[Bench_Kernel], benchCycles[Bench_Divide]);
+				vDisplayWriteStringAtPos(1, 0, cEngine);
+				snprintf_P(cTime, sizeof(cTime), PSTR("u32->float+div %4u"), benchCycles[Bench_ConvertDivide]);
+				vDisplayWriteStringAtPos(2, 0, cTime);
+				vDisplayWriteFlash(3, 0, PSTR("      BACK          "));
+				break;
 				
-				vDisplayWriteStringAtPos(3, 0, "START STOP     CHNG");
+			case State_Resume:
+				vDisplayWriteFlash(0, 0, PSTR("Resume calculation?"));
+				snprintf_P(cEngine, sizeof(cEngine), PSTR("Current: %s"), piEngines[engineIndex]->name);
+				vDisplayWriteStringAtPos(1, 0, cEngine);
+				snprintf_P(cTime, sizeof(cTime), PSTR("%lums %lut"), xResumeRecord.milliseconds, xResumeRecord.iterations);
+				vDisplayWriteStringAtPos(2, 0, cTime);
+				vDisplayWriteFlash(3, 0, PSTR("YES   NO            "));
 				break;
 				
 			default:
@@ -173,7 +662,163 @@ void vInterface(void *pvParameters) {
 	}
 }
 
+// Resets the lanes and the timer and starts every lane, lane 0 begins
+static void vRaceStart(void) {
+	TaskStatus_t xStatus;
+	uint8_t k;
+	
+	millisecondsStart = 0;
+	xTaskNotify(timeHandle, N_TIME_RST, eSetBits);
+	vTimerStart();
+	taskENTER_CRITICAL();
+	raceRunTimeStart = ulRunTimeCounter();
+	taskEXIT_CRITICAL();
+	
+	raceTurn = 0;
+	raceStopped = false;
+	raceSliceStart = xTaskGetTickCount();
+	for (k = 0; k < RACE_LANES; k++) {
+		vTaskGetInfo(raceLanes[k].handle, &xStatus, pdFALSE, eInvalid);
+		raceLanes[k].runTimeStart = xStatus.ulRunTimeCounter;
+		raceLanes[k].iterations = 0;
+		raceLanes[k].targetReached = false;
+		raceLanes[k].finished = false;
+	}
+	
+	xTaskNotify(raceLanes[0].handle, N_CALC_RACE, eSetBits);
+	for (k = 1; k < RACE_LANES; k++) {
+		xTaskNotify(raceLanes[k].handle, N_CALC_START | N_CALC_RST, eSetBits);
+	}
+}
+
+static void vRaceStop(void) {
+	uint8_t k;
+	
+	raceStopped = true;
+	for (k = 0; k < RACE_LANES; k++) {
+		xTaskNotify(raceLanes[k].handle, N_CALC_STOP, eSetBits);
+	}
+	vTimerStop();
+}
+
+// Hands the CPU to the next lane that is not finished yet and wakes it,
+// stops the timer once all are
+static void vRacePassTurn(uint8_t index) {
+	uint8_t next = index;
+	
+	do {
+		next = (next + 1) % RACE_LANES;
+	} while (raceLanes[next].finished && next != index);
+	
+	if (raceLanes[next].finished) {
+		vTimerStop();
+	}
+	raceSliceStart = xTaskGetTickCount();
+	raceTurn = next;
+	xTaskNotify(raceLanes[next].handle, N_CALC_TURN, eSetBits);
+}
+
+// Runs one lane until it is stopped, its engine finished or it certified
+// the target digits. Only the lane holding the turn is ready, the others
+// block until vRacePassTurn() or vRaceStop() notifies them. That makes
+// the turn and not the tick the unit of round robin, lets raceSlices set
+// its length and leaves the waiting lanes no CPU time at all.
+static void vRunRaceLane(raceLane_t *lane) {
+	ENGINE_CONST piEngine_t *engine = lane->engine;
+	uint8_t index = lane - raceLanes;
+	char latest[ENGINE_LATEST_DIGITS];
+	uint16_t batchSize = RACE_BATCH;
+	uint16_t digits;
+	uint16_t steps;
+	uint32_t ulMilliseconds;
+	uint16_t usMicroseconds;
+	
+	if (engine->batchLimit != 0 && batchSize > engine->batchLimit) {
+		batchSize = engine->batchLimit;
+	}
+	engine->init();
+	
+	for (;;) {
+		// Not a notification of its own, that would end the wait below
+		// right away and keep the waiting lanes spinning
+		if (raceStopped) {
+			break;
+		}
+		if (raceTurn != index) {
+			// A turn passed or a stop sent before the wait leaves the
+			// notification pending, so neither is missed
+			xTaskNotifyWait(0, N_CALC_TURN | N_CALC_STOP, NULL, portMAX_DELAY);
+			continue;
+		}
+		
+		steps = engine->stepBatch(batchSize);
+		vTimerLatch(&ulMilliseconds, &usMicroseconds);
+		lane->iterations += (uint32_t) steps * engine->termsPerStep;
+		
+		digits = engineCertifiedDigits(engine, latest);
+		if (targetReached(targetDigits[targetIndex], digits, latest)) {
+			lane->targetMilliseconds = ulMilliseconds;
+			lane->targetReached = true;
+		}
+		
+		// A lane is done once its target digits are certified
+		if (steps == 0 || lane->targetReached) {
+			lane->finished = true;
+			vRacePassTurn(index);
+			break;
+		}
+		if (xTaskGetTickCount() - raceSliceStart >= raceSlices[raceSliceIndex]) {
+			vRacePassTurn(index);
+		}
+	}
+}
+
+void vRaceLane(void *pvParameters) {
+	raceLane_t *lane = (raceLane_t *) pvParameters;
+	BaseType_t xResult;
+	uint32_t ulNotifyValue;
+	
+	for (;;) {
+		xResult = xTaskNotifyWait(pdFALSE, ULONG_MAX, &ulNotifyValue, portMAX_DELAY);
+		if (xResult == pdPASS && (ulNotifyValue & N_CALC_START)) {
+			vRunRaceLane(lane);
+		}
+	}
+}
+
+// Largest target up to index the engine can certify before rounding
+// takes over. Engines that certify none of them keep the first one, their
+// runs only end when stopped.
+static uint8_t ucReachableTarget(ENGINE_CONST piEngine_t *engine, uint8_t index) {
+	while (index > 0 && targetDigits[index] > engine->maxDigits) {
+		index--;
+	}
+	
+	return index;
+}
+
+// Starts a new run of piEngines[engineIndex], the time counters start
+// from zero
+static void vCalculationStart(void) {
+	snapshotReset(&xPiSnapshot);
+	millisecondsStart = 0;
+	
+	xTaskNotify(calculateHandle, N_CALC_START | N_CALC_RST, eSetBits);
+	
+	state = State_Started;
+	xCalcStartTick = xTaskGetTickCount();
+	
+	// Reset and start HW-Timer
+	xTaskNotify(timeHandle, N_TIME_RST, eSetBits);
+	vTimerStart();
+}
+
 void vButtonHandler(void *pvParameters) {
+	buttonState_t xButtonState;
+	uint32_t ulPredicted;
+	uint8_t ucAutoTarget;
+	uint8_t ucAutoEngine;
+	
 	initButtonHandler();
 	setupButton(BUTTON1, &PORTF, 4, 1);
 	setupButton(BUTTON2, &PORTF, 5, 1);
@@ -183,132 +828,444 @@ void vButtonHandler(void *pvParameters) {
 	
 	for(;;) {
 		// Start algorithm (means resuming the correct calculation task)
-		if(getButtonState(BUTTON1, true) == buttonState_Short && state == State_Stopped) {
-			if (algorithm == LEIBNIZ) {
-				xTaskNotify(leibnizHandle, N_CALC_START | N_CALC_RST, eSetBits);
-			} else {
-				xTaskNotify(wallisHandle, N_CALC_START | N_CALC_RST, eSetBits);
+		xButtonState = getButtonState(BUTTON1, true);
+		if(xButtonState == buttonState_Short && state == State_Stopped) {
+			vCalculationStart();
+		}
+		
+		// Start the engine the autotuner predicts to be fastest, with the
+		// target it can reach within the budget
+		if(xButtonState == buttonState_Short && state == State_Auto) {
+			ucAutoTarget = targetIndex;
+			if (autotunePick(&ucAutoTarget, autoBudgets[autoBudgetIndex] * 1000UL, &ucAutoEngine, &ulPredicted)) {
+				engineIndex = ucAutoEngine;
+				targetIndex = ucAutoTarget;
+				vCalculationStart();
 			}
+		}
+		
+		// Time the engines again on demand (long press)
+		if(xButtonState == buttonState_Long && state == State_Auto) {
+			calibrationReturn = State_Auto;
+			state = State_Calibrating;
+			xTaskNotify(calculateHandle, N_CALC_CALIBRATE, eSetBits);
+		}
+		
+		// Continue the run of the checkpoint found at boot, the time
+		// counters carry on from where it was saved
+		if(xButtonState == buttonState_Short && state == State_Resume) {
+			snapshotReset(&xPiSnapshot);
 			
-			state = State_Started;
-			
-			// Reset and start HW-Timer
+			millisecondsStart = xResumeRecord.milliseconds;
 			xTaskNotify(timeHandle, N_TIME_RST, eSetBits);
-			TCC1.CTRLA = TC_CLKSEL_DIV64_gc;
+			vTimerStart();
+			xCalcStartTick = xTaskGetTickCount() - xResumeRecord.milliseconds / portTICK_RATE_MS;
+			
+			xTaskNotify(calculateHandle, N_CALC_START | N_CALC_RESUME, eSetBits);
+			state = State_Started;
+		}
+		
+		// Start a race of all lanes (long press)
+		if(xButtonState == buttonState_Long && state == State_Stopped) {
+			vRaceStart();
+			state = State_Racing;
 		}
 		
 		// Stop algorithm (means deleting the currently running calculation task)
-		if(getButtonState(BUTTON2, true) == buttonState_Short && state == State_Started) {
-			if (algorithm == LEIBNIZ) {
-				xTaskNotify(leibnizHandle, N_CALC_STOP, eSetBits);
-			} else {
-				xTaskNotify(wallisHandle, N_CALC_STOP, eSetBits);
-			}
+		// or the race, a long press while stopped changes the race slice.
+		// While stopped a short press switches to the autotuner and back.
+		xButtonState = getButtonState(BUTTON2, true);
+		if(xButtonState == buttonState_Short && state == State_Started) {
+			xTaskNotify(calculateHandle, N_CALC_STOP, eSetBits);
 			
 			state = State_Stopped;
 			
 			// Stop HW-Timer
-			TCC1.CTRLA = 0x00;
+			vTimerStop();
+		} else if(xButtonState == buttonState_Short && state == State_Racing) {
+			vRaceStop();
+			state = State_Stopped;
+		} else if(xButtonState == buttonState_Short && state == State_Resume) {
+			// Discard the checkpoint so it is not offered again
+			xResumeRecord.active = false;
+			checkpointSave(&xResumeRecord);
+			state = State_Stopped;
+		} else if(xButtonState == buttonState_Short && state == State_Auto) {
+			// The autotuner offers every target, the engine may not reach it
+			targetIndex = ucReachableTarget(piEngines[engineIndex], targetIndex);
+			state = State_Stopped;
+		} else if(xButtonState == buttonState_Short && state == State_Benchmark && benchDone) {
+			state = State_Auto;
+		} else if(xButtonState == buttonState_Short && state == State_Stopped) {
+			state = State_Auto;
+		}
+		if(xButtonState == buttonState_Long && state == State_Stopped) {
+			raceSliceIndex = (raceSliceIndex + 1) % sizeof(raceSlices);
+		}
+		
+		// Change batch size (short) or the engine parameter (long),
+		// while running a short press switches the first display line view
+		xButtonState = getButtonState(BUTTON3, true);
+		if(xButtonState == buttonState_Short && state == State_Stopped) {
+			batchIndex = (batchIndex + 1) % (sizeof(batchSizes) / sizeof(batchSizes[0]));
+		} else if(xButtonState == buttonState_Short && state == State_Started) {
+			view = (view + 1) % View_Count;
+		} else if(xButtonState == buttonState_Short && state == State_Auto) {
+			autoBudgetIndex = (autoBudgetIndex + 1) % (sizeof(autoBudgets) / sizeof(autoBudgets[0]));
+		}
+		if(xButtonState == buttonState_Long && state == State_Stopped && piEngines[engineIndex]->stepParameter != NULL) {
+			piEngines[engineIndex]->stepParameter();
 		}
 		
-		// Change algorithm
-		if(getButtonState(BUTTON4, true) == buttonState_Short && state == State_Stopped) {
-			if (algorithm == LEIBNIZ) {
-				algorithm = WALLIS;
-			} else {
-				algorithm = LEIBNIZ;
+		// Change algorithm (short) or the precision target (long)
+		xButtonState = getButtonState(BUTTON4, true);
+		if(xButtonState == buttonState_Short && state == State_Stopped) {
+			engineIndex = (engineIndex + 1) % piEngineCount;
+			targetIndex = ucReachableTarget(piEngines[engineIndex], targetIndex);
+		}
+		if(xButtonState == buttonState_Long && state == State_Stopped) {
+			// Targets the engine cannot certify are skipped, the largest
+			// one it can wraps around to the first
+			targetIndex = (targetIndex + 1) % TARGET_COUNT;
+			if (targetDigits[targetIndex] > piEngines[engineIndex]->maxDigits) {
+				targetIndex = 0;
 			}
 		}
+		if(xButtonState == buttonState_Short && state == State_Auto) {
+			targetIndex = (targetIndex + 1) % TARGET_COUNT;
+		}
+		// Benchmark the reciprocal kernel against the float division (long)
+		if(xButtonState == buttonState_Long && state == State_Auto) {
+			benchDone = false;
+			state = State_Benchmark;
+			xTaskNotify(calculateHandle, N_CALC_BENCHMARK, eSetBits);
+		}
 		
 		vTaskDelay(10/portTICK_RATE_MS);
 	}
 }
 
-void vCalculateLeibniz(void *pvParameters) {
-	uint32_t i = 0;
-	BaseType_t xResult;
-	uint32_t ulNotifyValue;
+// Writes the state of the running engine as the newest checkpoint and
+// returns how long the EEPROM write took in ms
+static uint32_t ulSaveCheckpoint(ENGINE_CONST piEngine_t *engine, uint32_t iterations, uint32_t ulMilliseconds, bool active) {
+	checkpoint_t xRecord;
+	uint32_t ulStart;
+	uint32_t ulEnd;
+	uint16_t usMicroseconds;
 	
-	for (;;) {
-		xResult = xTaskNotifyWait(pdFALSE, ULONG_MAX, &ulNotifyValue, portMAX_DELAY);
+	memset(&xRecord, 0, sizeof(xRecord));
+	xRecord.engineIndex = engineIndex;
+	xRecord.batchIndex = batchIndex;
+	xRecord.targetIndex = targetIndex;
+	xRecord.active = active;
+	xRecord.iterations = iterations;
+	xRecord.milliseconds = ulMilliseconds;
+	if (active) {
+		engine->saveState(xRecord.state);
+	}
 	
-		if (xResult == pdPASS) {
-			if (ulNotifyValue & N_CALC_RST) {
-				pi = 1.0;
-				i = 0;
+	vTimerLatch(&ulStart, &usMicroseconds);
+	checkpointSave(&xRecord);
+	vTimerLatch(&ulEnd, &usMicroseconds);
+	
+	return ulEnd - ulStart;
+}
+
+// Times every engine from its init for the autotuner, until it finished,
+// reached the last target or used up its calibration time. Batches double
+// from a single step, so engines with slow steps do not overshoot much.
+static void vCalibrate(void) {
+	ENGINE_CONST piEngine_t *engine;
+	char latest[ENGINE_LATEST_DIGITS];
+	uint32_t ulLimit;
+	uint32_t ulCounts;
+	uint32_t terms;
+	uint16_t batchSize;
+	uint16_t steps;
+	uint8_t k;
+	
+	for (k = 0; k < autotuneEngineCount(); k++) {
+		calibrationIndex = k;
+		engine = piEngines[k];
+		ulLimit = (uint32_t) CALIBRATION_RUN_MS * TIMER_COUNTS_PER_MS;
+		if (engine->convergence == Convergence_Measured) {
+			ulLimit = (uint32_t) CALIBRATION_MEASURE_MS * TIMER_COUNTS_PER_MS;
+		} else if (engine->convergence == Convergence_None) {
+			// Never picked, a single batch is enough
+			ulLimit = 0;
+		}
+		autotuneRunReset(&xCalibrationRun);
+		terms = 0;
+		batchSize = 1;
+		
+		vTimerStart();
+		engine->init();
+		do {
+			steps = engine->stepBatch(batchSize);
+			terms += (uint32_t) steps * engine->termsPerStep;
+			autotuneRunFeed(&xCalibrationRun, terms, engineCertifiedDigits(engine, latest), latest);
+			
+			taskENTER_CRITICAL();
+			ulCounts = ulTimerElapsed();
+			taskEXIT_CRITICAL();
+			
+			if (batchSize < CALIBRATION_MAX_BATCH && (engine->batchLimit == 0 || batchSize < engine->batchLimit)) {
+				batchSize *= 2;
+			}
+		} while (steps > 0 && xCalibrationRun.terms[TARGET_COUNT - 1] == AUTOTUNE_NEVER && ulCounts < ulLimit);
+		vTimerStop();
+		
+		autotuneRunStore(k, &xCalibrationRun, terms, (float) ulCounts / TIMER_COUNTS_PER_MS, steps == 0);
+	}
+	autotuneCommit();
+}
+
+// Timer counts of BENCHMARK_CALLS reciprocals 1 / d for d = ulDenom,
+// ulDenom + 4, ... with interrupts off. The volatile operands keep the
+// compiler from hoisting the division out of the loop.
+static uint32_t ulBenchmarkRound(Bench_e variant, uint32_t ulDenom) {
+	volatile float fOne = 1.0;
+	volatile float fDivisor = ulDenom;
+	uint32_t ulStart;
+	uint32_t ulEnd;
+	uint8_t k;
+	
+	taskENTER_CRITICAL();
+	ulStart = ulTimerCounts();
+	switch (variant) {
+		case Bench_Kernel:
+			for (k = 0; k < BENCHMARK_CALLS; k++) {
+				benchSink = fReciprocal(ulDenom);
+				ulDenom += 4;
 			}
+			break;
 			
-			if (ulNotifyValue & N_CALC_START) {
-				for (;;) {
-					// Check if the calculation got interrupted (probably by the display task)
-					// and send an "empty" notification. This will cause this task to run once
-					// more without actually doing anything, but this is alright for the case
-					xTaskNotifyAndQuery(xTaskGetCurrentTaskHandle(), 0, eNoAction, &ulNotifyValue);
-					if (ulNotifyValue & N_CALC_STOP) {
-						break;
-					}
-					
-					// Lock pi (like taking a mutex)
-					xEventGroupClearBits(xEventGroup, EG_CALC_RELEASED);
-					
-					pi = pi - (1.0 / (3 + (4 * i))) + (1.0 / (5 + (4 * i)));
-					i++;
-					
-					// Release pi (like releasing a mutex)
-					xEventGroupSetBits(xEventGroup, EG_CALC_RELEASED);
-					
-					// If algorithm calculated PI up to 5 decimal places,
-					// stop the timer
-					if ((pi * 4) - PI_5DECIMALS < 0.00001) {
-						TCC1.CTRLA = 0x00;
-					}
-				}
+		case Bench_Divide:
+			for (k = 0; k < BENCHMARK_CALLS; k++) {
+				benchSink = fOne / fDivisor;
+				ulDenom += 4;
+			}
+			break;
+			
+		case Bench_ConvertDivide:
+			for (k = 0; k < BENCHMARK_CALLS; k++) {
+				benchSink = 1.0 / ulDenom;
+				ulDenom += 4;
+			}
+			break;
+			
+		default:
+			for (k = 0; k < BENCHMARK_CALLS; k++) {
+				benchSink = fDivisor;
+				ulDenom += 4;
+			}
+			break;
+	}
+	ulEnd = ulTimerCounts();
+	taskEXIT_CRITICAL();
+	
+	return ulEnd - ulStart;
+}
+
+// Cycles per reciprocal of every variant without the loop overhead, over
+// denominators from 3 up to 2^24, where fReciprocal() has to return the
+// same floats as the division
+static void vBenchmark(void) {
+	uint32_t ulCounts[Bench_Count];
+	uint32_t ulDenom;
+	uint16_t usMismatches = 0;
+	uint8_t variant;
+	uint8_t k;
+	uint8_t j;
+	
+	for (variant = 0; variant < Bench_Count; variant++) {
+		ulCounts[variant] = 0;
+	}
+	
+	vTimerStart();
+	for (k = 0; k < BENCHMARK_ROUNDS; k++) {
+		ulDenom = 3 + k * BENCHMARK_SPREAD;
+		for (variant = 0; variant < Bench_Count; variant++) {
+			ulCounts[variant] += ulBenchmarkRound(variant, ulDenom);
+		}
+		for (j = 0; j < BENCHMARK_CALLS; j++) {
+			if (fReciprocal(ulDenom + 4 * j) != (float) (1.0 / (ulDenom + 4 * j))) {
+				usMismatches++;
 			}
 		}
 	}
+	vTimerStop();
+	
+	for (variant = 0; variant < Bench_Count; variant++) {
+		benchCycles[variant] = ulCounts[variant] * CYCLES_PER_TIMER_COUNT / (BENCHMARK_CALLS * BENCHMARK_ROUNDS);
+		if (variant != Bench_Loop) {
+			benchCycles[variant] -= benchCycles[Bench_Loop];
+		}
+	}
+	benchMismatches = usMismatches;
+	benchDone = true;
 }
 
-void vCalculateWallis(void *pvParameters) {
+void vCalculate(void *pvParameters) {
+	ENGINE_CONST piEngine_t *engine = piEngines[engineIndex];
+	piSample_t xSample;
+	piExtrapolator_t xExtrapolator;
+	// Run time before the last start, the timer only counts since then
+	uint32_t ulTimeOffset = 0;
+	uint32_t ulNextCheckpoint = 0;
+	uint32_t ulCheckpointCost;
+	uint32_t iterations = 0;
+	uint32_t lastMilliseconds = 0;
+	uint16_t lastDigits = 0;
+	uint16_t batchSize;
+	uint16_t steps;
+	uint32_t ulEndMilliseconds;
+	uint16_t usEndMicroseconds;
 	BaseType_t xResult;
 	uint32_t ulNotifyValue;
-	float i = 3;
 	
-	for(;;) {
+	// No valid calibration table at boot
+	if (state == State_Calibrating) {
+		vCalibrate();
+		state = calibrationReturn;
+	}
+	
+	for (;;) {
 		xResult = xTaskNotifyWait(pdFALSE, ULONG_MAX, &ulNotifyValue, portMAX_DELAY);
-		
-		if (xResult == pdPASS) {
+	
+		if (xResult == pdPASS && (ulNotifyValue & N_CALC_CALIBRATE)) {
+			vCalibrate();
+			state = calibrationReturn;
+		} else if (xResult == pdPASS && (ulNotifyValue & N_CALC_BENCHMARK)) {
+			vBenchmark();
+		} else if (xResult == pdPASS && (ulNotifyValue & N_CALC_RACE)) {
+			// The calculation task doubles as lane 0 of a race
+			vRunRaceLane(&raceLanes[0]);
+		} else if (xResult == pdPASS) {
 			if (ulNotifyValue & N_CALC_RST) {
-				pi = 4.0;
-				i = 3.0;
+				engine = piEngines[engineIndex];
+				engine->init();
+				iterations = 0;
+				lastMilliseconds = 0;
+				lastDigits = 0;
+				extrapReset(&xExtrapolator);
+				xSample.targetReached = false;
+				ulTimeOffset = 0;
+				ulNextCheckpoint = CHECKPOINT_MIN_INTERVAL_MS;
+			}
+			
+			if (ulNotifyValue & N_CALC_RESUME) {
+				// Same as a reset, then the engine continues from the saved state.
+				// The accelerator and extrapolator start over from there.
+				engine = piEngines[engineIndex];
+				engine->init();
+				engine->loadState(xResumeRecord.state);
+				iterations = xResumeRecord.iterations;
+				lastMilliseconds = xResumeRecord.milliseconds;
+				lastDigits = 0;
+				extrapReset(&xExtrapolator);
+				xSample.targetReached = false;
+				ulTimeOffset = xResumeRecord.milliseconds;
+				ulNextCheckpoint = ulTimeOffset + CHECKPOINT_MIN_INTERVAL_MS;
 			}
 			
 			if (ulNotifyValue & N_CALC_START) {
+				batchSize = batchSizes[batchIndex];
+				if (engine->batchLimit != 0 && batchSize > engine->batchLimit) {
+					batchSize = engine->batchLimit;
+				}
+				
 				for (;;) {
 					// Check if the calculation got interrupted (probably by the display task)
 					// and send an "empty" notification. This will cause this task to run once
 					// more without actually doing anything, but this is alright for the case
 					xTaskNotifyAndQuery(xTaskGetCurrentTaskHandle(), 0, eNoAction, &ulNotifyValue);
 					if (ulNotifyValue & N_CALC_STOP) {
+						// A stopped run is not offered for resuming
+						if (engine->saveState != NULL) {
+							ulSaveCheckpoint(engine, iterations, ulGetMilliseconds(), false);
+						}
 						break;
 					}
-				
-					// Lock pi (like taking a mutex)
-					xEventGroupClearBits(xEventGroup, EG_CALC_RELEASED);
 					
-					pi = pi * ((i - 1) / i) * ((i + 1) / i);
-					i += 2;
+					// Compute a whole batch inside the engine, the kernel is only
+					// involved once per batch
+					steps = engine->stepBatch(batchSize);
+					vTimerLatch(&ulEndMilliseconds, &usEndMicroseconds);
+					ulEndMilliseconds += ulTimeOffset;
+					iterations += (uint32_t) steps * engine->termsPerStep;
+					
+					xSample.estimate = engine->estimate();
+					xSample.accelerated = xSample.estimate;
+					if (engine->accelerated != NULL) {
+						xSample.accelerated = engine->accelerated();
+					}
+					xSample.confidence = 0;
+					if (engine->confidence != NULL) {
+						xSample.confidence = engine->confidence();
+					}
+					xSample.iterations = iterations;
+					xSample.milliseconds = ulGetMilliseconds();
+					xSample.errorBound = engine->errorBound();
+					xSample.certified = engineCertifiedDigits(engine, xSample.latest);
+					xSample.digits = 0;
+					if (engine->digits != NULL) {
+						// Hex digits count for the display, not as certified
+						xSample.digits = engine->hexDigits ? engine->digits(xSample.latest) : xSample.certified;
+					}
+					
+					// Series and products whose error is a power series in 1/n
+					// also go through Richardson extrapolation, which only keeps
+					// samples at doubling term counts. Random estimates follow no
+					// such law.
+					xSample.best = xSample.estimate;
+					xSample.bestError = xSample.errorBound;
+					if (engine->convergence == Convergence_Algebraic) {
+						extrapFeed(&xExtrapolator, iterations, xSample.estimate);
+						extrapEstimate(&xExtrapolator, &xSample.best, &xSample.bestError);
+					}
+					
+					// Keep the timer count and term count of the batch that
+					// certified the precision target, the run ends with it
+					if (targetReached(targetDigits[targetIndex], xSample.certified, xSample.latest)) {
+						xSample.targetReached = true;
+						xSample.targetIterations = iterations;
+						xSample.targetMilliseconds = ulEndMilliseconds;
+						xSample.targetMicroseconds = usEndMicroseconds;
+					}
+					xSample.finished = (steps == 0 || xSample.targetReached);
+					if (xSample.finished) {
+						xSample.endTick = xTaskGetTickCount();
+					}
 					
-					// Release pi (like releasing a mutex)
-					xEventGroupSetBits(xEventGroup, EG_CALC_RELEASED);
+					// Cost and gain of this batch alone, measured on the
+					// millisecond counter of the time task
+					xSample.batchMilliseconds = xSample.milliseconds - lastMilliseconds;
+					xSample.batchDigits = xSample.digits - lastDigits;
+					lastMilliseconds = xSample.milliseconds;
+					lastDigits = xSample.digits;
+					snapshotPublish(&xPiSnapshot, &xSample);
 					
-					// If algorithm calculated PI up to 5 decimal places,
-					// stop the timer
-					float rest = pi - PI_5DECIMALS;
-					if (rest < 0.00001 && rest > 0.0) {
-						TCC1.CTRLA = 0x00;
+					if (engine->saveState != NULL && xSample.finished) {
+						ulSaveCheckpoint(engine, iterations, xSample.milliseconds, false);
+					} else if (engine->saveState != NULL && xSample.milliseconds >= ulNextCheckpoint) {
+						// Space the checkpoints so that writing them costs at
+						// most 1% of the run time, whatever the EEPROM takes
+						ulCheckpointCost = ulSaveCheckpoint(engine, iterations, xSample.milliseconds, true);
+						ulNextCheckpoint = xSample.milliseconds + CHECKPOINT_MIN_INTERVAL_MS;
+						if (ulCheckpointCost * CHECKPOINT_COST_FACTOR > CHECKPOINT_MIN_INTERVAL_MS) {
+							ulNextCheckpoint = xSample.milliseconds + ulCheckpointCost * CHECKPOINT_COST_FACTOR;
+						}
+					}
+					
+					if (xSample.finished) {
+						// The target is certified or the engine produced everything
+						// it can, stop the timer and wait for the next command
+						vTimerStop();
+						break;
 					}
 				}
 			}
 		}
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,276 @@
+/*
+ * mp_math.c
+ *
+ * Created: 17.10.2026 15:02:41
+ */ 
+
+#include "mp_math.h"
+
+void mpSetInt(mpLimb_t *x, uint16_t n, uint16_t value) {
+	uint16_t i;
+	
+	x[0] = value;
+	for (i = 1; i < n; i++) {
+		x[i] = 0;
+	}
+}
+
+void mpCopy(mpLimb_t *x, const mpLimb_t *y, uint16_t n) {
+	uint16_t i;
+	
+	for (i = 0; i < n; i++) {
+		x[i] = y[i];
+	}
+}
+
+bool mpIsZero(const mpLimb_t *x, uint16_t n) {
+	uint16_t i;
+	
+	for (i = 0; i < n; i++) {
+		if (x[i] != 0) {
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+uint16_t mpAdd(mpLimb_t *x, const mpLimb_t *y, uint16_t n) {
+	uint32_t sum;
+	uint16_t carry = 0;
+	uint16_t i = n;
+	
+	while (i-- > 0) {
+		sum = (uint32_t) x[i] + y[i] + carry;
+		x[i] = sum;
+		carry = sum >> 16;
+	}
+	
+	return carry;
+}
+
+uint16_t mpSub(mpLimb_t *x, const mpLimb_t *y, uint16_t n) {
+	uint32_t difference;
+	uint16_t borrow = 0;
+	uint16_t i = n;
+	
+	while (i-- > 0) {
+		difference = (uint32_t) x[i] - y[i] - borrow;
+		x[i] = difference;
+		borrow = (difference >> 16) ? 1 : 0;
+	}
+	
+	return borrow;
+}
+
+uint16_t mpMulSmall(mpLimb_t *x, uint16_t n, uint16_t factor) {
+	uint32_t product;
+	uint16_t carry = 0;
+	uint16_t i = n;
+	
+	while (i-- > 0) {
+		product = (uint32_t) x[i] * factor + carry;
+		x[i] = product;
+		carry = product >> 16;
+	}
+	
+	return carry;
+}
+
+uint16_t mpDivSmall(mpLimb_t *x, uint16_t n, uint16_t divisor) {
+	return mpDivSmallTo(x, x, n, divisor);
+}
+
+// Schoolbook division from the most significant limb. Leading zero limbs
+// are common for the shrinking series terms and skip the division.
+uint16_t mpDivSmallTo(mpLimb_t *x, const mpLimb_t *y, uint16_t n, uint16_t divisor) {
+	uint32_t dividend;
+	uint16_t quotient;
+	uint16_t remainder = 0;
+	uint16_t i;
+	
+	for (i = 0; i < n; i++) {
+		if (remainder == 0 && y[i] < divisor) {
+			remainder = y[i];
+			x[i] = 0;
+			continue;
+		}
+		dividend = ((uint32_t) remainder << 16) | y[i];
+		quotient = dividend / divisor;
+		remainder = dividend - (uint32_t) quotient * divisor;
+		x[i] = quotient;
+	}
+	
+	return remainder;
+}
+
+float mpToFloat(const mpLimb_t *x, uint16_t n) {
+	float value = x[0];
+	
+	if (n > 1) {
+		value += x[1] / 65536.0;
+	}
+	if (n > 2) {
+		value += x[2] / 4294967296.0;
+	}
+	
+	return value;
+}
+
+void mpSetFloat(mpLimb_t *x, uint16_t n, float value) {
+	uint16_t i;
+	
+	for (i = 0; i < n; i++) {
+		x[i] = value;
+		value = (value - x[i]) * 65536.0;
+	}
+}
+
+// Column-wise product from the least significant column. Columns below the
+// n limbs of the result only contribute carries, two of them are summed up
+// to keep the truncation error at a few units of the last limb. The column
+// sum is a 48-bit accumulator of a 32-bit low and a 16-bit high part.
+void mpMul(mpLimb_t *z, const mpLimb_t *x, const mpLimb_t *y, uint16_t n) {
+	uint32_t low = 0;
+	uint16_t high = 0;
+	uint32_t product;
+	uint16_t column = n + 1;
+	uint16_t i;
+	uint16_t first;
+	uint16_t last;
+	
+	for (;;) {
+		first = column < n ? 0 : column - (n - 1);
+		last = column < n ? column : n - 1;
+		
+		for (i = first; i <= last; i++) {
+			product = (uint32_t) x[i] * y[column - i];
+			low += product;
+			if (low < product) {
+				high++;
+			}
+		}
+		
+		if (column < n) {
+			z[column] = low;
+		}
+		if (column == 0) {
+			break;
+		}
+		
+		low = (low >> 16) | ((uint32_t) high << 16);
+		high = 0;
+		column--;
+	}
+}
+
+// The root is built from the top, bit is the square of its next bit. The
+// remainder x - root^2 decides whether the bit is set, root is kept shifted
+// left by the bits still to come so the test is a single subtraction.
+uint32_t ulSqrt64(uint64_t x) {
+	uint64_t root = 0;
+	uint64_t bit = 1ULL << 62;
+	
+	while (bit > x) {
+		bit >>= 2;
+	}
+	while (bit != 0) {
+		if (x >= root + bit) {
+			x -= root + bit;
+			root = (root >> 1) + bit;
+		} else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	
+	return root;
+}
+
+// Leading four limbs of x as an unsigned Q16.48 number
+static uint64_t mpLeading64(const mpLimb_t *x, uint16_t n) {
+	uint64_t value = 0;
+	uint8_t i;
+	
+	for (i = 0; i < 4; i++) {
+		value = (value << 16) | (i < n ? x[i] : 0);
+	}
+	
+	return value;
+}
+
+// Precision for the next Newton iteration towards n limbs. Every iteration
+// doubles the correct bits, starting from the 24 bits of the float seed.
+static uint16_t mpNextPrecision(uint16_t m, uint16_t n) {
+	m = 2 * m - 1;
+	
+	return m < n ? m : n;
+}
+
+// r = r * (2 - x * r)
+void mpReciprocal(mpLimb_t *r, const mpLimb_t *x, uint16_t n, mpLimb_t *scratch) {
+	mpLimb_t *product = scratch;
+	mpLimb_t *correction = scratch + n;
+	uint16_t m = 3 < n ? 3 : n;
+	uint16_t previous;
+	bool last = false;
+	
+	mpSetFloat(r, n, 1.0 / mpToFloat(x, n));
+	
+	while (!last) {
+		previous = m;
+		m = mpNextPrecision(m, n);
+		// One more iteration at full precision absorbs the seed error
+		last = previous == n;
+		
+		mpMul(product, x, r, m);
+		mpSetInt(correction, m, 2);
+		mpSub(correction, product, m);
+		mpMul(product, r, correction, m);
+		mpCopy(r, product, m);
+	}
+}
+
+// y = y * (3 - x * y^2) / 2
+void mpInvSqrt(mpLimb_t *y, const mpLimb_t *x, uint16_t n, mpLimb_t *scratch) {
+	mpLimb_t *product = scratch;
+	mpLimb_t *correction = scratch + n;
+	uint16_t m = 3 < n ? 3 : n;
+	uint16_t previous;
+	bool last = false;
+	uint64_t seed;
+	uint8_t i;
+	
+	// sqrt of Q16.48 is Q8.24, 2^56 over it is 1 / sqrt(x) in Q32.32
+	seed = ((uint64_t) 1 << 56) / ulSqrt64(mpLeading64(x, n));
+	for (i = 0; i < n && i < 3; i++) {
+		y[i] = seed >> (32 - 16 * i);
+	}
+	for (; i < n; i++) {
+		y[i] = 0;
+	}
+	
+	while (!last) {
+		previous = m;
+		m = mpNextPrecision(m, n);
+		last = previous == n;
+		
+		mpMul(product, y, y, m);
+		mpMul(correction, x, product, m);
+		mpSetInt(product, m, 3);
+		mpSub(product, correction, m);
+		mpMul(correction, y, product, m);
+		mpDivSmallTo(y, correction, m, 2);
+	}
+}
+
+// sqrt(x) = x / sqrt(x)
+void mpSqrt(mpLimb_t *z, const mpLimb_t *x, uint16_t n, mpLimb_t *scratch) {
+	mpInvSqrt(scratch, x, n, scratch + n);
+	mpMul(z, x, scratch, n);
+}
+
+void mpDiv(mpLimb_t *z, const mpLimb_t *x, const mpLimb_t *y, uint16_t n, mpLimb_t *scratch) {
+	mpReciprocal(scratch, y, n, scratch + n);
+	mpMul(z, x, scratch, n);
+}
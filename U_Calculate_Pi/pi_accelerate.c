@@ -0,0 +1,61 @@
+/*
+ * pi_accelerate.c
+ *
+ * Created: 17.10.2026 13:20:31
+ */ 
+
+#include "pi_accelerate.h"
+
+void accelReset(piAccelerator_t *accel) {
+	accel->count = 0;
+}
+
+void accelFeed(piAccelerator_t *accel, float sum) {
+	uint8_t k;
+	
+	for (k = 0; k < ACCEL_DEPTH - 1; k++) {
+		accel->sums[k] = accel->sums[k + 1];
+	}
+	accel->sums[ACCEL_DEPTH - 1] = sum;
+	
+	if (accel->count < ACCEL_DEPTH) {
+		accel->count++;
+	}
+}
+
+// Each round replaces three neighbouring sums s0, s1, s2 by
+// s2 - (s2 - s1)^2 / ((s2 - s1) - (s1 - s0)) and shortens the table by two,
+// until a single value is left. Until enough sums were fed it uses
+// as many rounds as it can.
+float accelEstimate(const piAccelerator_t *accel) {
+	float table[ACCEL_DEPTH];
+	float d1, d2;
+	uint8_t n = accel->count;
+	uint8_t k;
+	
+	if (n == 0) {
+		return 0.0;
+	}
+	if ((n & 1) == 0) {
+		n--;
+	}
+	for (k = 0; k < n; k++) {
+		table[k] = accel->sums[ACCEL_DEPTH - n + k];
+	}
+	
+	while (n >= 3) {
+		for (k = 0; k < n - 2; k++) {
+			d1 = table[k + 1] - table[k];
+			d2 = table[k + 2] - table[k + 1];
+			if (d2 != d1) {
+				table[k] = table[k + 2] - (d2 * d2) / (d2 - d1);
+			} else {
+				// Sums already converged to float precision
+				table[k] = table[k + 2];
+			}
+		}
+		n -= 2;
+	}
+	
+	return table[0];
+}
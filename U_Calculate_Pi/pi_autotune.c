@@ -0,0 +1,224 @@
+/*
+ * pi_autotune.c
+ *
+ * Created: 18.10.2026 19:13:21
+ */ 
+
+#include <math.h>
+#include <avr/io.h>
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+#include "pi_autotune.h"
+#include "pi_checkpoint.h"
+
+#if CHECKPOINT_EEPROM_SIZE + AUTOTUNE_EEPROM_SIZE > E2END + 1
+#error CHECKPOINT_EEPROM_SIZE and AUTOTUNE_EEPROM_SIZE exceed the EEPROM
+#endif
+
+// Layout of the table, part of the checksum so that a table written by
+// an older firmware is measured again instead of misread
+#define AUTOTUNE_LAYOUT        2
+
+// Calibration of one engine
+typedef struct {
+	float millisecondsPerTerm;         // average of the run, init included
+	uint32_t terms[TARGET_COUNT];      // AUTOTUNE_NEVER for targets out of reach
+} autotuneEntry_t;
+
+typedef struct {
+	uint32_t clock;                    // autotuneClock() the table was measured with
+	uint8_t engines;                   // entries in the table
+	uint16_t checksum;                 // over clock, engines and the entries
+} autotuneHeader_t;
+
+#if 7 + AUTOTUNE_ENGINES * 4 * (TARGET_COUNT + 1) > AUTOTUNE_EEPROM_SIZE
+#error AUTOTUNE_ENGINES too large for AUTOTUNE_EEPROM_SIZE
+#endif
+
+static autotuneHeader_t EEMEM autotuneHeader;
+static autotuneEntry_t EEMEM autotuneTable[AUTOTUNE_ENGINES];
+
+static bool tableValid;
+// Entry being stored, too large for the stack of the calculation task
+static autotuneEntry_t entry;
+
+// Clock source, prescalers, PLL and crystal settings as vInitClock() left
+// them. Any change to them invalidates the table, the engines are timed
+// again under the new setup.
+static uint32_t autotuneClock(void) {
+	return (uint32_t) CLK.CTRL | (uint32_t) CLK.PSCTRL << 8 | (uint32_t) OSC.PLLCTRL << 16 | (uint32_t) OSC.XOSCCTRL << 24;
+}
+
+uint8_t autotuneEngineCount(void) {
+	return piEngineCount < AUTOTUNE_ENGINES ? piEngineCount : AUTOTUNE_ENGINES;
+}
+
+static uint16_t autotuneChecksum(uint32_t clock, uint8_t engines) {
+	const uint8_t *data = (const uint8_t *) &clock;
+	const uint8_t *table = (const uint8_t *) autotuneTable;
+	uint16_t crc = 0xFFFF;
+	uint16_t k;
+	
+	for (k = 0; k < sizeof(clock); k++) {
+		crc = _crc_ccitt_update(crc, data[k]);
+	}
+	crc = _crc_ccitt_update(crc, engines);
+	crc = _crc_ccitt_update(crc, AUTOTUNE_LAYOUT);
+	for (k = 0; k < engines * sizeof(autotuneEntry_t); k++) {
+		crc = _crc_ccitt_update(crc, eeprom_read_byte(&table[k]));
+	}
+	
+	return crc;
+}
+
+// A table from before an engine was added or torn by a reset during the
+// calibration fails the engine count or the checksum
+bool autotuneInit(void) {
+	autotuneHeader_t header;
+	
+	eeprom_read_block(&header, &autotuneHeader, sizeof(header));
+	tableValid = header.clock == autotuneClock() && header.engines == autotuneEngineCount()
+		&& header.checksum == autotuneChecksum(header.clock, header.engines);
+	
+	return tableValid;
+}
+
+void autotuneRunReset(autotuneRun_t *run) {
+	uint8_t t;
+	
+	for (t = 0; t < TARGET_COUNT; t++) {
+		run->terms[t] = AUTOTUNE_NEVER;
+	}
+	run->firstTerms = 0;
+	run->firstDigits = 0;
+	run->peakTerms = 0;
+	run->peakDigits = 0;
+}
+
+// Only certified digits that match the reference count as a sample, an
+// error bound that is too optimistic must not steer the extrapolation
+void autotuneRunFeed(autotuneRun_t *run, uint32_t terms, uint16_t certified, const char *latest) {
+	uint8_t t;
+	
+	for (t = 0; t < TARGET_COUNT; t++) {
+		if (run->terms[t] == AUTOTUNE_NEVER && targetReached(targetDigits[t], certified, latest)) {
+			run->terms[t] = terms;
+		}
+	}
+	
+	if (certified == 0 || !targetReached(certified, certified, latest)) {
+		return;
+	}
+	if (run->firstDigits == 0) {
+		run->firstTerms = terms;
+		run->firstDigits = certified;
+	}
+	if (certified > run->peakDigits) {
+		run->peakTerms = terms;
+		run->peakDigits = certified;
+	}
+}
+
+// Terms to digits beyond the run, from its first and its peak sample. A
+// series gains the same digits for every tenfold of terms, so the terms
+// grow by the ratio between the samples for every (peak - first) digits.
+// A product like Viete's gains the same digits for the same terms.
+static uint32_t autotuneExtrapolate(ENGINE_CONST piEngine_t *engine, const autotuneRun_t *run, uint16_t digits) {
+	float steps;
+	float terms;
+	
+	if (digits > engine->maxDigits || run->peakDigits <= run->firstDigits) {
+		return AUTOTUNE_NEVER;
+	}
+	
+	steps = (float) (digits - run->peakDigits) / (run->peakDigits - run->firstDigits);
+	switch (engine->convergence) {
+		case Convergence_Algebraic:
+			terms = run->peakTerms * pow((float) run->peakTerms / run->firstTerms, steps);
+			break;
+			
+		case Convergence_Linear:
+			terms = run->peakTerms + steps * (run->peakTerms - run->firstTerms);
+			break;
+			
+		default:
+			return AUTOTUNE_NEVER;
+	}
+	
+	return terms < AUTOTUNE_NEVER ? (uint32_t) terms : AUTOTUNE_NEVER;
+}
+
+void autotuneRunStore(uint8_t engineIndex, const autotuneRun_t *run, uint32_t terms, float milliseconds, bool finished) {
+	ENGINE_CONST piEngine_t *engine = piEngines[engineIndex];
+	uint8_t t;
+	
+	tableValid = false;
+	entry.millisecondsPerTerm = terms > 0 ? milliseconds / terms : 0;
+	for (t = 0; t < TARGET_COUNT; t++) {
+		entry.terms[t] = run->terms[t];
+		if (engine->convergence == Convergence_None) {
+			entry.terms[t] = AUTOTUNE_NEVER;
+		} else if (entry.terms[t] == AUTOTUNE_NEVER && !finished) {
+			entry.terms[t] = autotuneExtrapolate(engine, run, targetDigits[t]);
+		}
+	}
+	eeprom_update_block(&entry, &autotuneTable[engineIndex], sizeof(entry));
+}
+
+void autotuneCommit(void) {
+	autotuneHeader_t header;
+	
+	header.clock = autotuneClock();
+	header.engines = autotuneEngineCount();
+	header.checksum = autotuneChecksum(header.clock, header.engines);
+	eeprom_update_block(&header, &autotuneHeader, sizeof(header));
+	tableValid = true;
+}
+
+uint32_t autotunePredict(uint8_t engineIndex, uint8_t targetIndex) {
+	uint32_t terms;
+	float millisecondsPerTerm;
+	float predicted;
+	
+	if (!tableValid || engineIndex >= autotuneEngineCount()) {
+		return AUTOTUNE_NEVER;
+	}
+	
+	terms = eeprom_read_dword(&autotuneTable[engineIndex].terms[targetIndex]);
+	if (terms == AUTOTUNE_NEVER) {
+		return AUTOTUNE_NEVER;
+	}
+	eeprom_read_block(&millisecondsPerTerm, &autotuneTable[engineIndex].millisecondsPerTerm, sizeof(millisecondsPerTerm));
+	predicted = terms * millisecondsPerTerm;
+	
+	return predicted < AUTOTUNE_NEVER ? (uint32_t) predicted : AUTOTUNE_NEVER;
+}
+
+bool autotunePick(uint8_t *targetIndex, uint32_t budget, uint8_t *engineIndex, uint32_t *predicted) {
+	uint8_t target = *targetIndex;
+	uint32_t best;
+	uint32_t time;
+	uint8_t k;
+	
+	for (;;) {
+		best = AUTOTUNE_NEVER;
+		for (k = 0; k < autotuneEngineCount(); k++) {
+			time = autotunePredict(k, target);
+			if (time < best) {
+				best = time;
+				*engineIndex = k;
+			}
+		}
+		
+		if (best != AUTOTUNE_NEVER && (budget == 0 || best <= budget)) {
+			*targetIndex = target;
+			*predicted = best;
+			return true;
+		}
+		// Without a budget the target stays what was asked for
+		if (budget == 0 || target == 0) {
+			return false;
+		}
+		target--;
+	}
+}
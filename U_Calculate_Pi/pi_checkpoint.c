@@ -0,0 +1,75 @@
+/*
+ * pi_checkpoint.c
+ *
+ * Created: 18.10.2026 11:03:10
+ */ 
+
+#include <stddef.h>
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+#include "pi_checkpoint.h"
+
+static checkpoint_t EEMEM checkpointRing[CHECKPOINT_SLOTS];
+
+static uint8_t newestSlot;
+static uint16_t newestSequence;
+static bool newestValid;
+
+static uint16_t checkpointChecksum(const checkpoint_t *record) {
+	const uint8_t *data = (const uint8_t *) record;
+	uint16_t crc = 0xFFFF;
+	uint8_t k;
+	
+	for (k = 0; k < offsetof(checkpoint_t, checksum); k++) {
+		crc = _crc_ccitt_update(crc, data[k]);
+	}
+	
+	return crc;
+}
+
+// The newest record has the highest sequence number. Numbers wrap around,
+// so a record is newer if it is less than half the range ahead. A record
+// torn by a reset in the middle of its write fails the checksum.
+void checkpointInit(void) {
+	checkpoint_t record;
+	uint8_t slot;
+	
+	newestValid = false;
+	for (slot = 0; slot < CHECKPOINT_SLOTS; slot++) {
+		eeprom_read_block(&record, &checkpointRing[slot], sizeof(record));
+		if (record.checksum != checkpointChecksum(&record)) {
+			continue;
+		}
+		if (!newestValid || (int16_t) (record.sequence - newestSequence) > 0) {
+			newestSlot = slot;
+			newestSequence = record.sequence;
+			newestValid = true;
+		}
+	}
+}
+
+bool checkpointLoad(checkpoint_t *record) {
+	if (!newestValid) {
+		return false;
+	}
+	
+	eeprom_read_block(record, &checkpointRing[newestSlot], sizeof(*record));
+	return record->checksum == checkpointChecksum(record) && record->active;
+}
+
+void checkpointSave(checkpoint_t *record) {
+	uint8_t slot = 0;
+	
+	if (newestValid) {
+		slot = (newestSlot + 1) % CHECKPOINT_SLOTS;
+	}
+	
+	record->sequence = newestSequence + 1;
+	record->checksum = checkpointChecksum(record);
+	// Only the bytes that changed are written
+	eeprom_update_block(record, &checkpointRing[slot], sizeof(*record));
+	
+	newestSlot = slot;
+	newestSequence = record->sequence;
+	newestValid = true;
+}
@@ -0,0 +1,119 @@
+/*
+ * pi_engine.c
+ *
+ * Created: 17.10.2026 10:04:02
+ */ 
+
+#include <math.h>
+#include <string.h>
+#include "pi_engine.h"
+
+uint32_t engineWorkspace[ENGINE_WORKSPACE_SIZE / 4];
+
+ENGINE_CONST piEngine_t * ENGINE_CONST piEngines[] = {
+	&leibnizEngine,
+	&leibnizFixedEngine,
+	&leibnizPairedEngine,
+	&leibnizCompensatedEngine,
+	&leibnizFloatFloatEngine,
+	&wallisEngine,
+	&wallisCompensatedEngine,
+	&wallisIntegerEngine,
+	&wallisFloatFloatEngine,
+	&nilakanthaEngine,
+	&vieteEngine,
+	&spigotEngine,
+	&bbpEngine,
+	&machinEngine,
+	&ramanujanEngine,
+	&agmEngine,
+	&monteCarloEngine,
+};
+
+const uint8_t piEngineCount = sizeof(piEngines) / sizeof(piEngines[0]);
+
+void engineClearDigits(char *latest) {
+	uint8_t i;
+	
+	for (i = 0; i < ENGINE_LATEST_DIGITS; i++) {
+		latest[i] = ' ';
+	}
+}
+
+// Appends a digit on the right, the oldest one drops out on the left
+void engineShiftDigit(char *latest, char digit) {
+	uint8_t i;
+	
+	for (i = 1; i < ENGINE_LATEST_DIGITS; i++) {
+		latest[i - 1] = latest[i];
+	}
+	latest[ENGINE_LATEST_DIGITS - 1] = digit;
+}
+
+void engineCopyDigits(char *buffer, const char *latest) {
+	uint8_t i;
+	
+	for (i = 0; i < ENGINE_LATEST_DIGITS; i++) {
+		buffer[i] = latest[i];
+	}
+}
+
+uint8_t *engineSaveValue(uint8_t *state, const void *value, uint8_t size) {
+	memcpy(state, value, size);
+	return state + size;
+}
+
+const uint8_t *engineLoadValue(const uint8_t *state, void *value, uint8_t size) {
+	memcpy(value, state, size);
+	return state + size;
+}
+
+uint8_t engineIntervalDigits(ffFloat_t value, float errorBound, char *latest, uint8_t limit) {
+	char lower[FF_DIGITS];
+	char upper[FF_DIGITS];
+	uint8_t count = 0;
+	
+	engineClearDigits(latest);
+	// ffToDigits needs both ends within [0, 10)
+	if (!(errorBound < value.hi && value.hi + errorBound < 10)) {
+		return 0;
+	}
+	if (limit > FF_DIGITS) {
+		limit = FF_DIGITS;
+	}
+	
+	// Both ends are exact float-float sums of the value and the bound
+	ffToDigits(ffSub(value, ffFromFloat(errorBound)), lower, limit);
+	ffToDigits(ffAdd(value, ffFromFloat(errorBound)), upper, limit);
+	while (count < limit && lower[count] == upper[count]) {
+		engineShiftDigit(latest, lower[count]);
+		count++;
+	}
+	
+	return count;
+}
+
+uint16_t engineCertifiedDigits(ENGINE_CONST piEngine_t *engine, char *latest) {
+	if (engine->digits != NULL) {
+		if (engine->hexDigits) {
+			engine->digits(latest);
+			return 0;
+		}
+		return engine->digits(latest);
+	}
+	return engineIntervalDigits(ffFromFloat(engine->estimate()), engine->errorBound(), latest, ENGINE_FLOAT_DIGITS);
+}
+
+float engineKahanRounding(uint32_t terms, float magnitude) {
+	// |error| <= (2u + O(n u^2)) * sum |x|, with 2 as the constant of the
+	// second order part
+	return (2 * ENGINE_ROUNDOFF + terms * (2 * ENGINE_ROUNDOFF * ENGINE_ROUNDOFF)) * magnitude;
+}
+
+float engineHalfUlp(float x) {
+	int exponent;
+	
+	// x = m * 2^exponent with 0.5 <= m < 1 and a 24 bit mantissa
+	frexp(x, &exponent);
+	return ldexp(1.0, exponent - 25);
+}
@@ -0,0 +1,70 @@
+/*
+ * pi_extrapolate.c
+ *
+ * Created: 17.10.2026 18:06:20
+ */ 
+
+#include <math.h>
+#include <float.h>
+#include "pi_extrapolate.h"
+
+void extrapReset(piExtrapolator_t *extrap) {
+	extrap->count = 0;
+	extrap->nextN = EXTRAP_MIN_N;
+}
+
+bool extrapFeed(piExtrapolator_t *extrap, uint32_t n, float estimate) {
+	uint8_t k;
+	
+	if (n < extrap->nextN) {
+		return false;
+	}
+	
+	if (extrap->count == EXTRAP_DEPTH) {
+		for (k = 0; k < EXTRAP_DEPTH - 1; k++) {
+			extrap->n[k] = extrap->n[k + 1];
+			extrap->estimate[k] = extrap->estimate[k + 1];
+		}
+		extrap->count--;
+	}
+	extrap->n[extrap->count] = n;
+	extrap->estimate[extrap->count] = estimate;
+	extrap->count++;
+	extrap->nextN = 2 * n;
+	
+	return true;
+}
+
+// Neville's scheme for the polynomial in h = 1/n through all samples,
+// evaluated at h = 0. Column j removes the error term in h^j:
+// T(i,j) = T(i,j-1) + (T(i,j-1) - T(i-1,j-1)) / (n(i) / n(i-j) - 1)
+// The change made by the last column serves as the error estimate. The
+// scheme also amplifies the rounding of the float samples, so the error
+// never drops below a few float ulps.
+bool extrapEstimate(const piExtrapolator_t *extrap, float *best, float *error) {
+	float table[EXTRAP_DEPTH];
+	float previous = 0.0;
+	uint8_t count = extrap->count;
+	uint8_t i, j;
+	
+	if (count < 2) {
+		return false;
+	}
+	
+	for (i = 0; i < count; i++) {
+		table[i] = extrap->estimate[i];
+	}
+	
+	// table[i] holds T(i,j), updated from the bottom so that T(i-1,j-1)
+	// is still there when T(i,j) is formed
+	for (j = 1; j < count; j++) {
+		previous = table[count - 1];
+		for (i = count - 1; i >= j; i--) {
+			table[i] = table[i] + (table[i] - table[i - 1]) / ((float) extrap->n[i] / extrap->n[i - j] - 1);
+		}
+	}
+	
+	*best = table[count - 1];
+	*error = fabs(table[count - 1] - previous) + 4 * FLT_EPSILON * fabs(table[count - 1]);
+	return true;
+}
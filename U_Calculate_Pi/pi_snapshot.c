@@ -0,0 +1,38 @@
+/*
+ * pi_snapshot.c
+ *
+ * Created: 17.10.2026 09:12:44
+ */ 
+
+#include <string.h>
+#include "pi_snapshot.h"
+
+// Keep the compiler from moving buffer accesses across a sequence update
+#define COMPILER_BARRIER() __asm__ __volatile__ ("" ::: "memory")
+
+void snapshotReset(piSnapshot_t *snapshot) {
+	memset(snapshot->buffer, 0, sizeof(snapshot->buffer));
+	COMPILER_BARRIER();
+	snapshot->sequence = 0;
+}
+
+void snapshotPublish(piSnapshot_t *snapshot, const piSample_t *sample) {
+	uint8_t next = snapshot->sequence + 1;
+	
+	memcpy(&snapshot->buffer[next & 1], sample, sizeof(piSample_t));
+	
+	// A single byte store is atomic on the AVR, this publishes the sample
+	COMPILER_BARRIER();
+	snapshot->sequence = next;
+}
+
+void snapshotRead(piSnapshot_t *snapshot, piSample_t *sample) {
+	uint8_t sequence;
+	
+	do {
+		sequence = snapshot->sequence;
+		COMPILER_BARRIER();
+		memcpy(sample, &snapshot->buffer[sequence & 1], sizeof(piSample_t));
+		COMPILER_BARRIER();
+	} while (sequence != snapshot->sequence);
+}
@@ -0,0 +1,53 @@
+/*
+ * pi_target.c
+ *
+ * Created: 18.10.2026 09:15:20
+ */ 
+
+#include <avr/pgmspace.h>
+#include "pi_target.h"
+#include "pi_engine.h"
+
+const uint16_t targetDigits[TARGET_COUNT] = { 4, 6, 7, 10, 14, 100, 1000 };
+
+static const char piReference[TARGET_REFERENCE_DIGITS] PROGMEM =
+	"31415926535897932384626433832795028841971693993751"
+	"05820974944592307816406286208998628034825342117067"
+	"98214808651328230664709384460955058223172535940812"
+	"84811174502841027019385211055596446229489549303819"
+	"64428810975665933446128475648233786783165271201909"
+	"14564856692346034861045432664821339360726024914127"
+	"37245870066063155881748815209209628292540917153643"
+	"67892590360011330530548820466521384146951941511609"
+	"43305727036575959195309218611738193261179310511854"
+	"80744623799627495673518857527248912279381830119491"
+	"29833673362440656643086021394946395224737190702179"
+	"86094370277053921717629317675238467481846766940513"
+	"20005681271452635608277857713427577896091736371787"
+	"21468440901224953430146549585371050792279689258923"
+	"54201995611212902196086403441815981362977477130996"
+	"05187072113499999983729780499510597317328160963185"
+	"95024459455346908302642522308253344685035261931188"
+	"17101000313783875288658753320838142061717766914730"
+	"35982534904287554687311595628638823537875937519577"
+	"81857780532171226806613001927876611195909216420198";
+
+bool targetReached(uint16_t digits, uint16_t certified, const char *latest) {
+	uint8_t shown = certified < ENGINE_LATEST_DIGITS ? certified : ENGINE_LATEST_DIGITS;
+	uint8_t k;
+	
+	if (certified < digits) {
+		return false;
+	}
+	if (certified > TARGET_REFERENCE_DIGITS) {
+		return true;
+	}
+	
+	// latest holds the most recent digits right aligned
+	for (k = 0; k < shown; k++) {
+		if (latest[ENGINE_LATEST_DIGITS - shown + k] != pgm_read_byte(&piReference[certified - shown + k])) {
+			return false;
+		}
+	}
+	return true;
+}
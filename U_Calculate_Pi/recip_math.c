@@ -0,0 +1,234 @@
+/*
+ * recip_math.c
+ *
+ * Created: 18.10.2026 20:31:42
+ */ 
+
+#include <string.h>
+#include <avr/pgmspace.h>
+#include "recip_math.h"
+
+// Bits of the normalised divisor after its leading one that select the seed
+#define RECIP_SEED_BITS       7
+
+// 2^24 / (257 + 2i) = 2^15 / v for v = (128.5 + i) / 256, the middle of
+// the i-th interval of v = d / 2^32. Good to 8 bits for every v in it.
+static const uint16_t recipSeed[1 << RECIP_SEED_BITS] PROGMEM = {
+	65281, 64777, 64281, 63792, 63310, 62836, 62369, 61909,
+	61455, 61008, 60568, 60133, 59705, 59283, 58867, 58457,
+	58053, 57654, 57260, 56872, 56489, 56111, 55738, 55370,
+	55007, 54649, 54295, 53946, 53601, 53261, 52925, 52593,
+	52265, 51942, 51622, 51306, 50995, 50686, 50382, 50081,
+	49784, 49490, 49200, 48913, 48630, 48349, 48072, 47798,
+	47528, 47260, 46995, 46733, 46474, 46218, 45965, 45714,
+	45467, 45222, 44979, 44739, 44502, 44267, 44035, 43805,
+	43577, 43352, 43129, 42908, 42690, 42474, 42260, 42048,
+	41838, 41631, 41425, 41222, 41020, 40820, 40623, 40427,
+	40233, 40041, 39851, 39662, 39476, 39291, 39108, 38926,
+	38746, 38568, 38392, 38217, 38044, 37872, 37702, 37533,
+	37366, 37200, 37036, 36873, 36712, 36552, 36393, 36236,
+	36080, 35926, 35772, 35620, 35470, 35320, 35172, 35026,
+	34880, 34735, 34592, 34450, 34309, 34169, 34031, 33893,
+	33757, 33622, 33487, 33354, 33222, 33091, 32961, 32832,
+};
+
+// a * b, returns the high half and writes the low one. avr-gcc widens
+// this to a 64 bit multiplication in software, here the 16 byte products
+// of the hardware multiplier are added row by row instead. Row i only
+// carries up to byte i + 4, which is still zero before it.
+static inline uint32_t ulMulFull(uint32_t a, uint32_t b, uint32_t *low) {
+#if defined(__AVR__)
+	uint32_t ulLow;
+	uint32_t ulHigh;
+	uint8_t zero;
+	
+	__asm__ (
+		"clr %A0"             "\n\t"
+		"clr %B0"             "\n\t"
+		"clr %C0"             "\n\t"
+		"clr %D0"             "\n\t"
+		"clr %A1"             "\n\t"
+		"clr %B1"             "\n\t"
+		"clr %C1"             "\n\t"
+		"clr %D1"             "\n\t"
+		"clr %4"              "\n\t"
+		"mul %A2, %A3"        "\n\t"
+		"add %A0, r0"         "\n\t"
+		"adc %B0, r1"         "\n\t"
+		"adc %C0, %4"         "\n\t"
+		"adc %D0, %4"         "\n\t"
+		"adc %A1, %4"         "\n\t"
+		"mul %A2, %B3"        "\n\t"
+		"add %B0, r0"         "\n\t"
+		"adc %C0, r1"         "\n\t"
+		"adc %D0, %4"         "\n\t"
+		"adc %A1, %4"         "\n\t"
+		"mul %A2, %C3"        "\n\t"
+		"add %C0, r0"         "\n\t"
+		"adc %D0, r1"         "\n\t"
+		"adc %A1, %4"         "\n\t"
+		"mul %A2, %D3"        "\n\t"
+		"add %D0, r0"         "\n\t"
+		"adc %A1, r1"         "\n\t"
+		"mul %B2, %A3"        "\n\t"
+		"add %B0, r0"         "\n\t"
+		"adc %C0, r1"         "\n\t"
+		"adc %D0, %4"         "\n\t"
+		"adc %A1, %4"         "\n\t"
+		"adc %B1, %4"         "\n\t"
+		"mul %B2, %B3"        "\n\t"
+		"add %C0, r0"         "\n\t"
+		"adc %D0, r1"         "\n\t"
+		"adc %A1, %4"         "\n\t"
+		"adc %B1, %4"         "\n\t"
+		"mul %B2, %C3"        "\n\t"
+		"add %D0, r0"         "\n\t"
+		"adc %A1, r1"         "\n\t"
+		"adc %B1, %4"         "\n\t"
+		"mul %B2, %D3"        "\n\t"
+		"add %A1, r0"         "\n\t"
+		"adc %B1, r1"         "\n\t"
+		"mul %C2, %A3"        "\n\t"
+		"add %C0, r0"         "\n\t"
+		"adc %D0, r1"         "\n\t"
+		"adc %A1, %4"         "\n\t"
+		"adc %B1, %4"         "\n\t"
+		"adc %C1, %4"         "\n\t"
+		"mul %C2, %B3"        "\n\t"
+		"add %D0, r0"         "\n\t"
+		"adc %A1, r1"         "\n\t"
+		"adc %B1, %4"         "\n\t"
+		"adc %C1, %4"         "\n\t"
+		"mul %C2, %C3"        "\n\t"
+		"add %A1, r0"         "\n\t"
+		"adc %B1, r1"         "\n\t"
+		"adc %C1, %4"         "\n\t"
+		"mul %C2, %D3"        "\n\t"
+		"add %B1, r0"         "\n\t"
+		"adc %C1, r1"         "\n\t"
+		"mul %D2, %A3"        "\n\t"
+		"add %D0, r0"         "\n\t"
+		"adc %A1, r1"         "\n\t"
+		"adc %B1, %4"         "\n\t"
+		"adc %C1, %4"         "\n\t"
+		"adc %D1, %4"         "\n\t"
+		"mul %D2, %B3"        "\n\t"
+		"add %A1, r0"         "\n\t"
+		"adc %B1, r1"         "\n\t"
+		"adc %C1, %4"         "\n\t"
+		"adc %D1, %4"         "\n\t"
+		"mul %D2, %C3"        "\n\t"
+		"add %B1, r0"         "\n\t"
+		"adc %C1, r1"         "\n\t"
+		"adc %D1, %4"         "\n\t"
+		"mul %D2, %D3"        "\n\t"
+		"add %C1, r0"         "\n\t"
+		"adc %D1, r1"         "\n\t"
+		"clr __zero_reg__"
+		: "=&r" (ulLow), "=&r" (ulHigh), "=&r" (zero)
+		: "r" (a), "r" (b)
+	);
+	*low = ulLow;
+	
+	return ulHigh;
+#else
+	uint64_t product = (uint64_t) a * b;
+	
+	*low = product;
+	return product >> 32;
+#endif
+}
+
+// Two Newton steps z' = z + z (1 - v z) towards z = 1 / v, kept as 2^31 z.
+// The first one only needs the rounded upper half of d and 16 x 16 bit
+// products, the second one works on the bits 18 to 49 of 2^63 - d z.
+uint32_t ulReciprocalEstimate(uint32_t d) {
+	uint16_t usSeed = pgm_read_word(&recipSeed[(d >> (31 - RECIP_SEED_BITS)) & ((1 << RECIP_SEED_BITS) - 1)]);
+	uint32_t ulProduct = (uint32_t) (uint16_t) (d >> 16) * usSeed;
+	uint32_t ulZ = (uint32_t) usSeed << 16;
+	uint32_t ulHigh;
+	uint32_t ulLow;
+	uint32_t ulError;
+	
+	if (d & 0x8000) {
+		ulProduct += usSeed;
+	}
+	if (ulProduct <= 0x80000000UL) {
+		ulZ += ((uint32_t) usSeed * (uint16_t) ((0x80000000UL - ulProduct) >> 8)) >> 7;
+	} else {
+		ulZ -= ((uint32_t) usSeed * (uint16_t) ((ulProduct - 0x80000000UL) >> 8)) >> 7;
+	}
+	
+	ulHigh = ulMulFull(d, ulZ, &ulLow);
+	if (ulHigh < 0x80000000UL) {
+		// d z below 2^63, z too small
+		ulError = ((0x80000000UL - ulHigh - (ulLow != 0)) << 14) | (-ulLow >> 18);
+		ulZ += ulMulFull(ulZ, ulError, &ulLow) >> 13;
+	} else {
+		ulError = ((ulHigh - 0x80000000UL) << 14) | (ulLow >> 18);
+		ulZ -= ulMulFull(ulZ, ulError, &ulLow) >> 13;
+	}
+	
+	return ulZ;
+}
+
+// Moves an estimate z to floor(2^63 / d) with the remainder 2^63 - d z
+static uint32_t ulReciprocalCorrect(uint32_t d, uint32_t ulZ) {
+	uint32_t ulLow;
+	uint32_t ulHigh = ulMulFull(d, ulZ, &ulLow);
+	uint64_t ullRest = (1ULL << 63) - (((uint64_t) ulHigh << 32) | ulLow);
+	
+	while ((int64_t) ullRest < 0) {
+		ulZ--;
+		ullRest += d;
+	}
+	while (ullRest >= d) {
+		ulZ++;
+		ullRest -= d;
+	}
+	
+	return ulZ;
+}
+
+// Shifts d left until its top bit is set, returns the shift
+static uint8_t ucNormalise(uint32_t *d) {
+	uint8_t shift = 0;
+	
+	while (!(*d & 0xFF000000UL)) {
+		*d <<= 8;
+		shift += 8;
+	}
+	while (!(*d & 0x80000000UL)) {
+		*d <<= 1;
+		shift++;
+	}
+	
+	return shift;
+}
+
+// 1 / d = 2^(s - 63) floor(2^63 / (d 2^s)) rounded to 24 bits. A quotient
+// of integers never lies halfway between two floats, so the round bit
+// alone decides. It is only computed exactly if the estimate could be on
+// either side of it.
+float fReciprocal(uint32_t d) {
+	uint8_t shift = ucNormalise(&d);
+	uint32_t ulMantissa = 1UL << 24;
+	uint32_t ulZ;
+	uint32_t ulBits;
+	float result;
+	
+	if (d != 0x80000000UL) {
+		ulZ = ulReciprocalEstimate(d);
+		if (((ulZ - RECIP_ESTIMATE_ERROR) ^ (ulZ + RECIP_ESTIMATE_ERROR)) >> 7) {
+			ulZ = ulReciprocalCorrect(d, ulZ);
+		}
+		ulMantissa = (ulZ >> 8) + ((ulZ >> 7) & 1);
+	}
+	
+	// The leading mantissa bit, or the carry of rounding up to 2^24,
+	// lands in the exponent
+	ulBits = ((uint32_t) (shift + 94) << 23) + ulMantissa;
+	memcpy(&result, &ulBits, sizeof(result));
+	
+	return result;
+}